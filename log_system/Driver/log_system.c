@@ -43,6 +43,10 @@
 #define DIGITS_IN_HEX_32_T      8
 #define DIGITS_IN_BIN_32_T      32
 
+#define FRAME_SYNC_0            0xA5
+#define FRAME_SYNC_1            0x5A
+#define FRAME_HEADER_SIZE       5
+
 
 
 UART_HandleTypeDef *p_uart_global;
@@ -195,6 +199,55 @@ void log_message_with_signed_val(log_system_config_t *p_config,
 }
 
 
+/*
+ * Sends a binary frame in a single UART transmit, for compact periodic data
+ * such as telemetry. The frame is 0xA5 0x5A sync bytes, the frame type, the
+ * payload length (16 bit little endian), the payload, then a checksum byte,
+ * the XOR of the type, length and payload bytes. Frames with payloads longer
+ * than LOG_FRAME_MAX_PAYLOAD are not sent.
+ * @param p_config is a pointer to the log_system config object. Instantiate
+ * the config object at the head of each file where logging is required and
+ * pass it's address into this function.
+ * @param level is the level status of the frame - see log_type_t for
+ * available options.
+ * @param type identifies the payload layout to the receiving tool.
+ * @param payload is a pointer to the payload bytes.
+ * @param length is the number of payload bytes.
+ */
+void log_binary_frame(log_system_config_t *p_config,
+                      log_type_t level,
+                      uint8_t type,
+                      const uint8_t *payload,
+                      uint16_t length)
+{
+    // Sync bytes, type and length, the payload, then the checksum.
+    static uint8_t frame[FRAME_HEADER_SIZE + LOG_FRAME_MAX_PAYLOAD + 1];
+
+    if (length > LOG_FRAME_MAX_PAYLOAD ||
+        !log_message_preference_check(p_config, level))
+    {
+        return;
+    }
+
+    frame[0] = FRAME_SYNC_0;
+    frame[1] = FRAME_SYNC_1;
+    frame[2] = type;
+    frame[3] = (uint8_t)(length & 0xFF);
+    frame[4] = (uint8_t)(length >> 8);
+    memcpy(&frame[FRAME_HEADER_SIZE], payload, length);
+
+    uint8_t checksum = frame[2] ^ frame[3] ^ frame[4];
+    for (uint16_t index = 0; index < length; ++index)
+    {
+        checksum ^= payload[index];
+    }
+    frame[FRAME_HEADER_SIZE + length] = checksum;
+
+    HAL_UART_Transmit(p_uart_global, frame,
+                      FRAME_HEADER_SIZE + length + 1, TIMEOUT_MS);
+}
+
+
 /*
  * Sets maximum output level of logging required, to be used at file scope.
  * @param p_config is a pointer to the log_system config object. Instantiate
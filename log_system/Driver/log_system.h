@@ -35,6 +35,14 @@
 
 #include "stm32f4xx_hal.h"
 
+/**
+ * Largest payload that log_binary_frame() will send. Define this in your
+ * build flags to override the default.
+ */
+#ifndef LOG_FRAME_MAX_PAYLOAD
+#define LOG_FRAME_MAX_PAYLOAD   256
+#endif
+
 /**
  * Enumerated constants for the type of message to be logged.
  */
@@ -140,6 +148,28 @@ void log_message_with_signed_val(log_system_config_t *p_config,
                                             format_type_t format);
 
 
+/**
+ * Sends a binary frame in a single UART transmit, for compact periodic data
+ * such as telemetry. The frame is 0xA5 0x5A sync bytes, the frame type, the
+ * payload length (16 bit little endian), the payload, then a checksum byte,
+ * the XOR of the type, length and payload bytes. Frames with payloads longer
+ * than LOG_FRAME_MAX_PAYLOAD are not sent.
+ * @param p_config is a pointer to the log_system config object. Instantiate
+ * the config object at the head of each file where logging is required and
+ * pass it's address into this function.
+ * @param level is the level status of the frame - see log_type_t for
+ * available options.
+ * @param type identifies the payload layout to the receiving tool.
+ * @param payload is a pointer to the payload bytes.
+ * @param length is the number of payload bytes.
+ */
+void log_binary_frame(log_system_config_t *p_config,
+                      log_type_t level,
+                      uint8_t type,
+                      const uint8_t *payload,
+                      uint16_t length);
+
+
 /**
  * Sets maximum output level of logging required, to be used at file scope.
  * @param p_config is a pointer to the log_system config object. Instantiate
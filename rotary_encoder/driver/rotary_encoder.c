@@ -30,11 +30,23 @@
  */
 
 #include "rotary_encoder.h"
+#include "rotary_encoder_decode.h"
+#include "rotary_encoder_port.h"
 #include "stm32f4xx_hal.h"
 
 #include "log_system.h"
 
-#define MAX_NUM_OF_ENCODERS   5
+/**
+ * Type for intermediate counter arithmetic, wide enough that adding a step
+ * cannot overflow before the result is clamped. 16 bit counters keep native
+ * 32 bit arithmetic. 64 bit counters have no wider type, so update_counter()
+ * checks their sum for overflow instead.
+ */
+#if ROT_ENC_COUNTER_BITS == 16
+typedef int32_t rot_enc_wide_count_t;
+#else
+typedef int64_t rot_enc_wide_count_t;
+#endif
 
 // -------- Log system configuration. -------- //
 log_system_config_t log_rot_enc = 
@@ -53,21 +65,130 @@ log_system_config_t log_rot_enc =
 static rot_enc_handle_t *registered_handles[MAX_NUM_OF_ENCODERS] = {NULL};
 
 
+#if ROT_ENC_TRACE_DEPTH > 0
+#if (ROT_ENC_TRACE_DEPTH & (ROT_ENC_TRACE_DEPTH - 1)) != 0
+#error "ROT_ENC_TRACE_DEPTH must be a power of 2"
+#endif
+
+/**
+ * Trace recorder ring buffer per encoder, indexed by id. trace_count is the
+ * number of entries recorded since the last dump, so the newest entry is at
+ * (trace_count - 1) masked to the depth.
+ */
+static uint32_t trace_buffer[MAX_NUM_OF_ENCODERS][ROT_ENC_TRACE_DEPTH];
+static uint32_t trace_count[MAX_NUM_OF_ENCODERS];
+static uint32_t trace_last_time[MAX_NUM_OF_ENCODERS];
+static uint32_t trace_dropped[MAX_NUM_OF_ENCODERS];
+static volatile bool trace_paused[MAX_NUM_OF_ENCODERS];
+#endif
+
+// Telemetry payload header, then the size of each encoder's record, which
+// carries the counter at its full width.
+#define TELEMETRY_HEADER_SIZE     5
+#define TELEMETRY_COUNTER_SIZE    ((ROT_ENC_COUNTER_BITS == 64) ? 8 : 4)
+#define TELEMETRY_RECORD_SIZE     (21 + TELEMETRY_COUNTER_SIZE)
+
+// Encoders per telemetry frame, more are split across several frames.
+#define TELEMETRY_RECORDS_PER_FRAME \
+  ((LOG_FRAME_MAX_PAYLOAD - TELEMETRY_HEADER_SIZE) / TELEMETRY_RECORD_SIZE)
+
+#if TELEMETRY_RECORDS_PER_FRAME < 1
+#error "LOG_FRAME_MAX_PAYLOAD is too small for a telemetry frame"
+#endif
+
+/**
+ * Period between telemetry frames, and when the last one was sent.
+ */
+static uint32_t telemetry_period = ROT_ENC_TELEMETRY_PERIOD_MS;
+static uint32_t telemetry_last_time = 0;
+
+/**
+ * Store for persisted counters, set by rot_enc_set_store().
+ */
+static const rot_enc_store_t *position_store = NULL;
+
+
+#if MAX_NUM_OF_ENCODERS > 32
+#error "MAX_NUM_OF_ENCODERS must be 32 or less, to fit the dirty mask"
+#endif
+
+/**
+ * Bit per registered encoder, set by the ISR when its counter changes and
+ * cleared by rot_enc_process_changes().
+ */
+static volatile uint32_t dirty_mask = 0;
+
+
+#if (ROT_ENC_BUTTON_QUEUE_SIZE & (ROT_ENC_BUTTON_QUEUE_SIZE - 1)) != 0
+#error "ROT_ENC_BUTTON_QUEUE_SIZE must be a power of 2"
+#endif
+
+/**
+ * Single-producer, single-consumer button event queue, written by
+ * rot_enc_tick() and read by rot_enc_get_button_event().
+ */
+static rot_enc_button_event_t button_queue[ROT_ENC_BUTTON_QUEUE_SIZE];
+static volatile uint8_t button_queue_head = 0;
+static volatile uint8_t button_queue_tail = 0;
+
+
+#if ROT_ENC_EVENT_QUEUE_SIZE > 0
+#if (ROT_ENC_EVENT_QUEUE_SIZE & (ROT_ENC_EVENT_QUEUE_SIZE - 1)) != 0
+#error "ROT_ENC_EVENT_QUEUE_SIZE must be a power of 2"
+#endif
+
 /**
- * Lookup table to determine if a transition is valid.
- * 4 bit phase transition value from encoder corresponds to decimal index 0-15.
+ * Single-producer, single-consumer event queue. The head index is only
+ * written from interrupt context, and the tail index only from the main
+ * loop, so no locking is needed.
  */
-static int8_t rot_enc_lookup_table[16] =
-{0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+static rot_enc_event_t event_queue[ROT_ENC_EVENT_QUEUE_SIZE];
+static volatile uint16_t event_queue_head = 0;
+static volatile uint16_t event_queue_tail = 0;
+static volatile uint32_t dropped_events = 0;
+#endif
 
 
 // ------------------------------------------------------------------------- //
 // --------------------- Utility function prototypes ----------------------- //
 // ------------------------------------------------------------------------- // 
 uint8_t get_state(rot_enc_handle_t *handle_ptr);
+uint8_t pin_to_shift(uint16_t pin);
 rot_enc_handle_t* determine_trigger(uint16_t GPIO_Pin);
 void decode_phase_transition(rot_enc_handle_t *handle_ptr);
+void process_transition(rot_enc_handle_t *handle_ptr, uint8_t transition);
+void update_counter(rot_enc_handle_t *handle_ptr, int32_t step, uint32_t now);
+rot_enc_wide_count_t wrap_count(rot_enc_handle_t *handle_ptr,
+                                rot_enc_wide_count_t count);
+uint16_t get_accel_multiplier(rot_enc_handle_t *handle_ptr, uint32_t interval);
+rot_enc_wide_count_t scale_step(rot_enc_handle_t *handle_ptr,
+                                rot_enc_wide_count_t delta);
+void notify_change(rot_enc_handle_t *handle_ptr, int32_t delta, uint32_t now);
+void queue_event(rot_enc_handle_t *handle_ptr, int32_t delta, uint32_t now);
+void record_edge(rot_enc_handle_t *handle_ptr, int8_t step, uint32_t now);
+void update_motion_estimate(rot_enc_handle_t *handle_ptr);
+uint32_t rot_enc_enter_critical(void);
+void rot_enc_exit_critical(uint32_t primask);
 void print_debug_info(rot_enc_handle_t *handle_ptr);
+void update_button(rot_enc_handle_t *handle_ptr, uint32_t now);
+void button_event(rot_enc_handle_t *handle_ptr,
+                  rot_enc_button_event_type_t type);
+void button_click(rot_enc_handle_t *handle_ptr);
+void reset_counter(rot_enc_handle_t *handle_ptr);
+void set_counter(rot_enc_handle_t *handle_ptr, rot_enc_count_t value);
+void latch_index(rot_enc_handle_t *handle_ptr);
+bool detect_storm(rot_enc_handle_t *handle_ptr);
+void poll_storm(rot_enc_handle_t *handle_ptr, uint32_t now);
+void sync_timer_backend(rot_enc_handle_t *handle_ptr);
+void record_transitions(rot_enc_handle_t *handle_ptr,
+                        int32_t net_steps,
+                        uint32_t transitions,
+                        uint32_t now);
+int32_t floor_div(int32_t value, int32_t divisor);
+int32_t map_value(const rot_enc_map_t *map_ptr, rot_enc_count_t count);
+void restore_position(rot_enc_handle_t *handle_ptr);
+void record_trace(rot_enc_handle_t *handle_ptr, uint8_t transition);
+uint8_t* pack_u32(uint8_t *buffer, uint32_t value);
 
 
 // ------------------------------------------------------------------------- //
@@ -86,15 +207,54 @@ bool init_rotary_encoder(rot_enc_handle_t* handle_ptr)
 {
   bool registration_success = false;
 
+  if (handle_ptr->timer != NULL)
+  {
+    // Timer backed, so only the hardware count needs capturing.
+    handle_ptr->timer_last_cnt = handle_ptr->timer->CNT;
+    handle_ptr->timer_residue = 0;
+  }
+  else
+  {
+    // Precompute IDR bit positions for same port reads in get_state().
+    handle_ptr->shift_a = pin_to_shift(handle_ptr->pin_a);
+    handle_ptr->shift_b = pin_to_shift(handle_ptr->pin_b);
+    handle_ptr->same_port = (handle_ptr->port_a == handle_ptr->port_b);
+
+    // Start from the real pin state, so the first edge is decoded correctly.
+    handle_ptr->old_state = get_state(handle_ptr);
+    handle_ptr->new_state = handle_ptr->old_state;
+  }
+
+  // Start the motion estimate from rest.
+  handle_ptr->last_edge_time = ROT_ENC_GET_TIMESTAMP();
+  handle_ptr->last_count_time = handle_ptr->last_edge_time;
+  handle_ptr->sample_time = handle_ptr->last_edge_time;
+  handle_ptr->sample_position = handle_ptr->position;
+
   for (int index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
   {
     if (registered_handles[index] == NULL)
     {
       registered_handles[index] = handle_ptr;
+      handle_ptr->id = index;
       registration_success = true;
       break;
     }
   }
+
+#if ROT_ENC_TRACE_DEPTH > 0
+  if (registration_success)
+  {
+    trace_count[handle_ptr->id] = 0;
+    trace_last_time[handle_ptr->id] = handle_ptr->last_edge_time;
+  }
+#endif
+
+  if (registration_success && handle_ptr->persist && position_store != NULL)
+  {
+    restore_position(handle_ptr);
+  }
+
   //print_debug_info(handle_ptr);
   return registration_success;
 }
@@ -105,7 +265,7 @@ bool init_rotary_encoder(rot_enc_handle_t* handle_ptr)
  * HAL_GPIO_EXTI_Callback(). 
  * This function will determine which encoder triggered the interrupt,
  * determine whether the input is valid, and increment/decrement the counter.
- * (Or reset it if button pushed).
+ * (Or reset it if button pushed, or latch it on an index pulse).
  * @param takes the GPIO pin number that triggered the interrupt.
  */
 void rot_enc_callback(uint16_t GPIO_Pin)
@@ -113,111 +273,1717 @@ void rot_enc_callback(uint16_t GPIO_Pin)
   // Local variable to store handle pointer for encoder that triggered ISR. 
   rot_enc_handle_t *handle_ptr = determine_trigger(GPIO_Pin);
 
-  // If button was pushed, reset count.
+  // Ignore pins which do not belong to a registered encoder.
+  if (handle_ptr == NULL)
+  {
+    return;
+  }
+
+  // If button was pushed, reset count. Debounced buttons are sampled by
+  // rot_enc_tick() instead.
   if (handle_ptr->button_pin == GPIO_Pin)
   {
-    handle_ptr->counter = handle_ptr->reset_value;
+    if (handle_ptr->button_port == NULL)
+    {
+      reset_counter(handle_ptr);
+    }
+  }
+
+  // If the index pin triggered interrupt, latch the position.
+  else if (handle_ptr->index_pin == GPIO_Pin)
+  {
+    latch_index(handle_ptr);
   }
 
   //  If rotary encoder pins triggered interrupt, run encoder algorithm.
   else
   {
+    if (handle_ptr->storm_threshold != 0)
+    {
+      detect_storm(handle_ptr);
+    }
     decode_phase_transition(handle_ptr);
   }
 }
 
 
+/*
+ * Decodes a new pin state for an encoder read by the caller, e.g. by the
+ * compile-time dispatch in rotary_encoder_static.h, and updates the counter
+ * if the transition is valid.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the new state of pins A and B, in 0b000000AB format.
+ */
+void rot_enc_update_state(rot_enc_handle_t *handle_ptr, uint8_t new_state)
+{
+  handle_ptr->new_state = new_state;
+
+  // Pack new pin states into nibble with old pin state. 
+  uint8_t transition = (handle_ptr->old_state << 2) |
+                       (handle_ptr->new_state);
+
+#if ROT_ENC_TRACE_DEPTH > 0
+  record_trace(handle_ptr, transition);
+#endif
+
+  process_transition(handle_ptr, transition);
+
+  // Update old state for next run.
+  handle_ptr->old_state = handle_ptr->new_state;
+}
+
+
+/*
+ * Call this function every millisecond, e.g. from HAL_SYSTICK_Callback() or a
+ * timer period elapsed callback, at the same interrupt priority as the
+ * encoder EXTI interrupts. Samples and debounces buttons which have a
+ * button_port set, and reports their gestures. Also polls encoders whose
+ * interrupts are masked due to an interrupt storm, and reads timer backed
+ * encoders often enough that their count cannot overflow between reads.
+ */
+void rot_enc_tick(void)
+{
+  uint32_t now = HAL_GetTick();
+
+  for (int index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    rot_enc_handle_t *handle_ptr = registered_handles[index];
+
+    if (handle_ptr == NULL)
+    {
+      continue;
+    }
+
+    if (handle_ptr->button_port != NULL)
+    {
+      update_button(handle_ptr, now);
+    }
+
+    if (handle_ptr->storm_active)
+    {
+      poll_storm(handle_ptr, now);
+    }
+
+    if (handle_ptr->timer != NULL)
+    {
+      sync_timer_backend(handle_ptr);
+    }
+  }
+}
+
+
+/*
+ * Takes the oldest debounced button event from the queue. Call this from the
+ * main loop only.
+ * @param takes a pointer to a rot_enc_button_event_t object to copy into.
+ * @return true if an event was copied, false if the queue was empty.
+ */
+bool rot_enc_get_button_event(rot_enc_button_event_t *event_ptr)
+{
+  uint8_t tail = button_queue_tail;
+
+  if (tail == button_queue_head)
+  {
+    return false;
+  }
+
+  *event_ptr = button_queue[tail];
+
+  // Make sure the entry has been read before handing the slot back.
+  __DMB();
+  button_queue_tail = (tail + 1U) & (ROT_ENC_BUTTON_QUEUE_SIZE - 1U);
+
+  return true;
+}
+
+
 /**
+ * Reads the counter without tearing, for any ROT_ENC_COUNTER_BITS.
  * @param takes a pointer to a rot_enc_handle_t object.
  * @return the current counter value for the specified encoder.
  */
-int16_t rot_enc_get_count_value(rot_enc_handle_t* handle_ptr)
+rot_enc_count_t rot_enc_get_count_value(rot_enc_handle_t* handle_ptr)
 {
+    if (handle_ptr->timer != NULL)
+    {
+      sync_timer_backend(handle_ptr);
+    }
+
+#if ROT_ENC_COUNTER_BITS == 64
+    // A 64 bit read takes two loads, so keep the ISR out between them.
+    uint32_t primask = rot_enc_enter_critical();
+    rot_enc_count_t count = handle_ptr->counter;
+    rot_enc_exit_critical(primask);
+    return count;
+#else
+    // 16 and 32 bit reads are a single load, so cannot tear.
     return handle_ptr->counter;
+#endif
 }
 
 
-// ------------------------------------------------------------------------- //
-// ------------------------- Private Utility Functions --------------------- //
-// ------------------------------------------------------------------------- //
+/*
+ * Captures the counters of several encoders at the same instant, in one short
+ * critical section, so ISRs cannot update some of them part way through.
+ * Timer backed encoders are synced inside the same critical section.
+ * @param takes a pointer to an array of MAX_NUM_OF_ENCODERS counts, indexed
+ * by encoder id. Only the entries selected by the mask are written.
+ * @param takes a bitfield of the encoders to capture, bit n being the encoder
+ * with id n.
+ * @return the timestamp of the snapshot.
+ */
+uint32_t rot_enc_snapshot(rot_enc_count_t *counts, uint32_t mask)
+{
+  uint32_t primask = rot_enc_enter_critical();
+  uint32_t now = ROT_ENC_GET_TIMESTAMP();
+
+  for (uint8_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    rot_enc_handle_t *handle_ptr = registered_handles[index];
+    if ((mask & (1UL << index)) == 0 || handle_ptr == NULL)
+    {
+      continue;
+    }
 
+    if (handle_ptr->timer != NULL)
+    {
+      sync_timer_backend(handle_ptr);
+    }
+    counts[index] = handle_ptr->counter;
+  }
 
-/**
+  rot_enc_exit_critical(primask);
+  return now;
+}
+
+
+/*
+ * Reads the counter and passes it through the handle's map, using integer
+ * interpolation only.
  * @param takes a pointer to a rot_enc_handle_t object.
- * @return digital state of pins A and B from inside handle struct, as a 2 bit
- * number.
+ * @return the mapped value, or the counter value if no map is set.
  */
-uint8_t get_state(rot_enc_handle_t *handle_ptr)
+int32_t rot_enc_get_mapped_value(rot_enc_handle_t *handle_ptr)
 {
-  uint8_t temp = 0;
-  // Pack Pin_A and Pin_B values into a single variable 0b000000AB.
-  temp = HAL_GPIO_ReadPin(handle_ptr->port_a, handle_ptr->pin_a) << 1;
-  temp |= HAL_GPIO_ReadPin(handle_ptr->port_b, handle_ptr->pin_b);
-  return temp; 
+  rot_enc_count_t count = rot_enc_get_count_value(handle_ptr);
+
+  if (handle_ptr->map == NULL)
+  {
+    return (int32_t)count;
+  }
+  return map_value(handle_ptr->map, count);
 }
 
 
-/**
- * @param takes the GPIO pin number that triggered the interrupt.
- * @return pointer to the handle struct of the encoder that triggered the
- * interrupt.
- */ 
-rot_enc_handle_t* determine_trigger(uint16_t GPIO_Pin)
+/*
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return true once an index pulse has been seen since init.
+ */
+bool rot_enc_get_index_seen(rot_enc_handle_t *handle_ptr)
 {
-  rot_enc_handle_t *handle_ptr = NULL;
+  return handle_ptr->index_seen;
+}
+
+
+/*
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the counter value latched at the last index pulse, before any
+ * auto-zero.
+ */
+rot_enc_count_t rot_enc_get_index_position(rot_enc_handle_t *handle_ptr)
+{
+#if ROT_ENC_COUNTER_BITS == 64
+  uint32_t primask = rot_enc_enter_critical();
+  rot_enc_count_t position = handle_ptr->index_position;
+  rot_enc_exit_critical(primask);
+  return position;
+#else
+  return handle_ptr->index_position;
+#endif
+}
+
+
+/*
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the number of index pulses seen, incremented or decremented by the
+ * direction of rotation at each one.
+ */
+int32_t rot_enc_get_revolutions(rot_enc_handle_t *handle_ptr)
+{
+  return handle_ptr->revolutions;
+}
+
+
+/*
+ * Estimates shaft speed, by measuring the period between edges at low speed
+ * and counting transitions per window at high speed.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the velocity in transitions per second, positive when incrementing.
+ */
+int32_t rot_enc_get_velocity(rot_enc_handle_t *handle_ptr)
+{
+  if (handle_ptr->timer != NULL)
+  {
+    sync_timer_backend(handle_ptr);
+  }
+  update_motion_estimate(handle_ptr);
+  return handle_ptr->velocity;
+}
+
+
+/*
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the filtered acceleration in transitions per second per second.
+ */
+int32_t rot_enc_get_acceleration(rot_enc_handle_t *handle_ptr)
+{
+  if (handle_ptr->timer != NULL)
+  {
+    sync_timer_backend(handle_ptr);
+  }
+  update_motion_estimate(handle_ptr);
+  return handle_ptr->acceleration;
+}
+
+
+/*
+ * Initialises a bank of encoders for polled decoding, and registers each of
+ * its handles. Do not enable EXTI interrupts on the bank's A/B pins.
+ * @param takes a pointer to a rot_enc_bank_t object.
+ * @return returns true if every handle is on the bank's port with its B pin
+ * at b_offset from its A pin, and registry was successful, false if not, in
+ * which case none of the handles are registered.
+ */
+bool init_rotary_encoder_bank(rot_enc_bank_t *bank_ptr)
+{
+  bank_ptr->a_mask = 0;
+
+  for (int bit = 0; bit < 16; ++bit)
+  {
+    bank_ptr->handle_by_bit[bit] = NULL;
+  }
 
+  // Check every handle before registering any, so a bad bank leaves the
+  // registry as it was.
+  int free_slots = 0;
   for (int index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
   {
-    if (registered_handles[index]->pin_a == GPIO_Pin ||
-        registered_handles[index]->pin_b == GPIO_Pin ||
-        registered_handles[index]->button_pin == GPIO_Pin)
+    free_slots += (registered_handles[index] == NULL);
+  }
+  if (bank_ptr->num_of_handles > free_slots)
+  {
+    return false;
+  }
+
+  for (int index = 0; index < bank_ptr->num_of_handles; ++index)
+  {
+    rot_enc_handle_t *handle_ptr = bank_ptr->handles[index];
+
+    // Bit-parallel decoding relies on every pair having the same layout.
+    if (handle_ptr->port_a != bank_ptr->port ||
+        handle_ptr->port_b != bank_ptr->port ||
+        handle_ptr->pin_a == 0 ||
+        handle_ptr->pin_b != (uint16_t)(handle_ptr->pin_a <<
+                                          bank_ptr->b_offset))
     {
-      handle_ptr = registered_handles[index];
-      break;
+      return false;
     }
   }
-  return handle_ptr;
+
+  for (int index = 0; index < bank_ptr->num_of_handles; ++index)
+  {
+    rot_enc_handle_t *handle_ptr = bank_ptr->handles[index];
+
+    init_rotary_encoder(handle_ptr);
+
+    bank_ptr->a_mask |= handle_ptr->pin_a;
+    bank_ptr->handle_by_bit[handle_ptr->shift_a] = handle_ptr;
+  }
+
+  // Capture the starting pin states for the first poll.
+  uint32_t idr = rot_enc_port_read(bank_ptr->port);
+  bank_ptr->old_a = idr & bank_ptr->a_mask;
+  bank_ptr->old_b = (idr >> bank_ptr->b_offset) & bank_ptr->a_mask;
+
+  return true;
 }
 
 
-/**
- * Decodes the phase transition from the encoder, and stores the new state.
- * @param takes a pointer to a rot_enc_handle_t object.
+/*
+ * Insert this function into your overridden definition of
+ * HAL_TIM_PeriodElapsedCallback() for the timer used to poll the bank. The
+ * polling rate must be faster than the fastest expected edge rate.
+ * @param takes a pointer to a rot_enc_bank_t object.
  */
-void decode_phase_transition(rot_enc_handle_t *handle_ptr)
+void rot_enc_poll_bank(rot_enc_bank_t *bank_ptr)
 {
-  // Get new pin states. 
-  handle_ptr->new_state = get_state(handle_ptr);
+  // Read the whole port once, and line each B bit up with its A bit.
+  uint32_t idr = rot_enc_port_read(bank_ptr->port);
+  uint16_t a = idr & bank_ptr->a_mask;
+  uint16_t b = (idr >> bank_ptr->b_offset) & bank_ptr->a_mask;
 
-  // Pack new pin states into nibble with old pin state. 
-  uint8_t transition = (handle_ptr->old_state << 2) |
-                       (handle_ptr->new_state);
+  uint16_t changed_a = a ^ bank_ptr->old_a;
+  uint16_t changed_b = b ^ bank_ptr->old_b;
+
+  // A valid transition changes exactly one phase. If both change, a step has
+  // been missed and the transition is rejected, as with the lookup table.
+  uint16_t valid = changed_a ^ changed_b;
+
+  // Incrementing if A changed to differ from B, or B changed to match A.
+  uint16_t incrementing = valid & (a ^ b ^ changed_b);
 
-  // Use lookup table to edit counter ONLY if pin transitions are valid.
-  // (lookup_value = 0 if invalid.)
-  int8_t lookup_value = rot_enc_lookup_table[transition];
+  bank_ptr->old_a = a;
+  bank_ptr->old_b = b;
 
-  // Test if we are decrementing. 
-  if (lookup_value < 0)
+  // Only visit the encoders whose pins changed.
+  uint16_t moved = changed_a | changed_b;
+  while (moved)
   {
-    // Check lower limit. 
-    if (handle_ptr->counter > handle_ptr->counter_min)
+    uint8_t bit = __builtin_ctz(moved);
+    uint16_t bit_mask = (uint16_t)(1U << bit);
+    rot_enc_handle_t *handle_ptr = bank_ptr->handle_by_bit[bit];
+
+    // Keep the handle state in step with the bank, in 0b000000AB format.
+    handle_ptr->new_state = (uint8_t)((((a & bit_mask) != 0) << 1) |
+                                      ((b & bit_mask) != 0));
+
+    if (handle_ptr->resolution != ROT_ENC_RESOLUTION_4X)
+    {
+      // Detent counting needs the state machine, so fall back to the table.
+      process_transition(handle_ptr, (handle_ptr->old_state << 2) |
+                                     handle_ptr->new_state);
+    }
+    else if (valid & bit_mask)
     {
-      handle_ptr->counter += lookup_value;
+      int8_t step = (incrementing & bit_mask) ? 1 : -1;
+      uint32_t now = ROT_ENC_GET_TIMESTAMP();
+      record_edge(handle_ptr, step, now);
+      update_counter(handle_ptr, step, now);
     }
+    else
+    {
+      // Both phases changed between polls, let the table count it, and
+      // recover the step if enabled.
+      process_transition(handle_ptr, (handle_ptr->old_state << 2) |
+                                     handle_ptr->new_state);
+    }
+
+    handle_ptr->old_state = handle_ptr->new_state;
+
+    moved &= (uint16_t)(moved - 1U);
+  }
+}
+
+
+/*
+ * Decodes a block of GPIO input data register samples, captured by a timer
+ * triggered DMA transfer from the port's IDR into a circular buffer. Call this
+ * from the DMA half transfer and transfer complete callbacks, passing the half
+ * of the buffer that has just been filled. Pins A and B must be on the
+ * sampled port, and must not have EXTI interrupts enabled.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes a pointer to the IDR samples, oldest first.
+ * @param takes the number of samples.
+ */
+void rot_enc_decode_samples(rot_enc_handle_t *handle_ptr,
+                            const uint16_t *samples,
+                            uint32_t num_of_samples)
+{
+  if (num_of_samples == 0)
+  {
+    return;
   }
-  // Test if we are incrementing.
-  else if (lookup_value > 0)
+
+  uint32_t now = ROT_ENC_GET_TIMESTAMP();
+  uint32_t shift_a = handle_ptr->shift_a;
+  uint32_t shift_b = handle_ptr->shift_b;
+
+  // Detent counting and skipped-step recovery need the state machine, so
+  // walk the samples and pass each change through the table.
+  if (handle_ptr->resolution != ROT_ENC_RESOLUTION_4X ||
+      handle_ptr->recover_skipped_steps)
   {
-    // Check upper limit. 
-    if (handle_ptr->counter < handle_ptr->counter_max)
+    for (uint32_t index = 0; index < num_of_samples; ++index)
     {
-      handle_ptr->counter += lookup_value;
+      uint8_t state = (uint8_t)((((samples[index] >> shift_a) & 1U) << 1) |
+                                ((samples[index] >> shift_b) & 1U));
+      if (state != handle_ptr->old_state)
+      {
+        handle_ptr->new_state = state;
+        process_transition(handle_ptr, (handle_ptr->old_state << 2) | state);
+        handle_ptr->old_state = state;
+      }
     }
+    return;
   }
 
-  // Update old state for next run.
-  handle_ptr->old_state = handle_ptr->new_state;
+  rot_enc_block_result_t result;
+  handle_ptr->old_state = rot_enc_decode_block(samples,
+                                               num_of_samples,
+                                               shift_a,
+                                               shift_b,
+                                               handle_ptr->old_state,
+                                               &result);
+  handle_ptr->new_state = handle_ptr->old_state;
+  handle_ptr->stats.invalid_transitions += result.invalid_transitions;
+
+  record_transitions(handle_ptr, result.net_steps, result.transitions, now);
+  if (result.net_steps != 0)
+  {
+    update_counter(handle_ptr, result.net_steps, now);
+  }
+}
+
+
+/*
+ * Copies the transition statistics for an encoder, optionally clearing them
+ * in the same critical section so no transitions are lost between the two.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes a pointer to a rot_enc_stats_t object to copy into.
+ * @param takes true to reset the statistics after copying.
+ */
+void rot_enc_get_stats(rot_enc_handle_t *handle_ptr,
+                       rot_enc_stats_t *stats_ptr,
+                       bool reset)
+{
+  uint32_t primask = rot_enc_enter_critical();
+  *stats_ptr = handle_ptr->stats;
+  if (reset)
+  {
+    handle_ptr->stats.valid_steps = 0;
+    handle_ptr->stats.invalid_transitions = 0;
+    handle_ptr->stats.bounces = 0;
+    handle_ptr->stats.storms = 0;
+  }
+  rot_enc_exit_critical(primask);
+}
+
+
+/*
+ * Sets the store used to persist counters of handles with persist set. Call
+ * this before init_rotary_encoder(), so counters can be restored.
+ * @param takes a pointer to a rot_enc_store_t object, or NULL to disable
+ * persistence.
+ */
+void rot_enc_set_store(const rot_enc_store_t *store_ptr)
+{
+  position_store = store_ptr;
+}
+
+
+/*
+ * Writes persisted counters to the store once they have held still for
+ * ROT_ENC_PERSIST_DELAY_MS. Call this from the main loop, as flash writes
+ * can be slow.
+ */
+void rot_enc_save_positions(void)
+{
+  if (position_store == NULL)
+  {
+    return;
+  }
+
+  uint32_t now = HAL_GetTick();
+
+  for (uint8_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    rot_enc_handle_t *handle_ptr = registered_handles[index];
+    if (handle_ptr == NULL || !handle_ptr->persist)
+    {
+      continue;
+    }
+
+    rot_enc_count_t count = rot_enc_get_count_value(handle_ptr);
+
+    if (count == handle_ptr->persist_value)
+    {
+      // Already stored, or turned back before the write was due.
+      handle_ptr->persist_candidate = count;
+    }
+    else if (count != handle_ptr->persist_candidate)
+    {
+      // Still moving, so restart the delay.
+      handle_ptr->persist_candidate = count;
+      handle_ptr->persist_change_time = now;
+    }
+    else if (now - handle_ptr->persist_change_time >= ROT_ENC_PERSIST_DELAY_MS)
+    {
+      position_store->write(handle_ptr->id, count);
+      handle_ptr->persist_value = count;
+    }
+  }
+}
+
+
+/*
+ * Bitfield of encoders whose counter has changed since the last call to
+ * rot_enc_process_changes(), bit n being the encoder with id n. Lets the main
+ * loop check every encoder with a single word test.
+ * @return the dirty mask.
+ */
+uint32_t rot_enc_get_dirty_mask(void)
+{
+  return dirty_mask;
+}
+
+
+/*
+ * Clears the dirty mask, and calls the on_change callback of every encoder
+ * that had changed. Call this from the main loop only.
+ * @return the dirty mask that was processed.
+ */
+uint32_t rot_enc_process_changes(void)
+{
+  // Take and clear the mask together, so no change is missed in between.
+  uint32_t primask = rot_enc_enter_critical();
+  uint32_t mask = dirty_mask;
+  dirty_mask = 0;
+  rot_enc_exit_critical(primask);
+
+  uint32_t remaining = mask;
+  for (uint8_t index = 0; remaining != 0; ++index, remaining >>= 1)
+  {
+    if ((remaining & 1U) == 0)
+    {
+      continue;
+    }
+
+    rot_enc_handle_t *handle_ptr = registered_handles[index];
+    if (handle_ptr != NULL && handle_ptr->on_change != NULL)
+    {
+      handle_ptr->on_change(handle_ptr);
+    }
+  }
+
+  return mask;
+}
+
+
+/*
+ * Sends the counter, velocity and statistics of every registered encoder as
+ * one binary log frame, see log_binary_frame(), at most once per telemetry
+ * period. Encoders that do not fit in LOG_FRAME_MAX_PAYLOAD spill into
+ * further frames. Call this from the main loop. The payload, all little
+ * endian, is the timestamp (uint32_t) and number of encoders (uint8_t), then
+ * for each encoder its id (uint8_t), counter (int32_t, or int64_t when
+ * ROT_ENC_COUNTER_BITS is 64), velocity (int32_t), and valid_steps,
+ * invalid_transitions, bounces and storms (uint32_t).
+ */
+void rot_enc_publish_telemetry(void)
+{
+  uint32_t now = HAL_GetTick();
+
+  if (telemetry_period == 0 || now - telemetry_last_time < telemetry_period)
+  {
+    return;
+  }
+  telemetry_last_time = now;
+
+  uint8_t payload[TELEMETRY_HEADER_SIZE +
+                  TELEMETRY_RECORD_SIZE * TELEMETRY_RECORDS_PER_FRAME];
+  uint32_t timestamp = ROT_ENC_GET_TIMESTAMP();
+  uint8_t *write_ptr = pack_u32(payload, timestamp) + 1;
+  uint8_t num_of_records = 0;
+
+  for (uint8_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    rot_enc_handle_t *handle_ptr = registered_handles[index];
+    if (handle_ptr == NULL)
+    {
+      continue;
+    }
+
+    rot_enc_stats_t stats;
+    rot_enc_get_stats(handle_ptr, &stats, false);
+
+    *write_ptr++ = handle_ptr->id;
+#if ROT_ENC_COUNTER_BITS == 64
+    uint64_t count = (uint64_t)rot_enc_get_count_value(handle_ptr);
+    write_ptr = pack_u32(write_ptr, (uint32_t)count);
+    write_ptr = pack_u32(write_ptr, (uint32_t)(count >> 32));
+#else
+    write_ptr = pack_u32(write_ptr,
+                         (uint32_t)(int32_t)rot_enc_get_count_value(handle_ptr));
+#endif
+    write_ptr = pack_u32(write_ptr,
+                         (uint32_t)rot_enc_get_velocity(handle_ptr));
+    write_ptr = pack_u32(write_ptr, stats.valid_steps);
+    write_ptr = pack_u32(write_ptr, stats.invalid_transitions);
+    write_ptr = pack_u32(write_ptr, stats.bounces);
+    write_ptr = pack_u32(write_ptr, stats.storms);
+
+    // Send a full frame, and start the next one with the same timestamp.
+    if (++num_of_records == TELEMETRY_RECORDS_PER_FRAME)
+    {
+      payload[TELEMETRY_HEADER_SIZE - 1] = num_of_records;
+      log_binary_frame(&log_rot_enc, DEBUG, ROT_ENC_TELEMETRY_FRAME_TYPE,
+                       payload, (uint16_t)(write_ptr - payload));
+      write_ptr = payload + TELEMETRY_HEADER_SIZE;
+      num_of_records = 0;
+    }
+  }
+
+  if (num_of_records != 0)
+  {
+    payload[TELEMETRY_HEADER_SIZE - 1] = num_of_records;
+    log_binary_frame(&log_rot_enc, DEBUG, ROT_ENC_TELEMETRY_FRAME_TYPE,
+                     payload, (uint16_t)(write_ptr - payload));
+  }
+}
+
+
+/*
+ * Sets the period between telemetry frames.
+ * @param takes the period in ms, or 0 to stop telemetry.
+ */
+void rot_enc_set_telemetry_period(uint32_t period_ms)
+{
+  telemetry_period = period_ms;
+}
+
+
+#if ROT_ENC_TRACE_DEPTH > 0
+/*
+ * Logs an encoder's trace, oldest entry first, then clears it. Recording for
+ * that encoder is paused during the dump so the trace stays coherent, while
+ * other encoders carry on recording. Each entry is logged in hex, see
+ * ROT_ENC_TRACE_ENTRY() in rotary_encoder_decode.h, and the dump can be
+ * replayed on a PC with tools/rot_enc_trace_replay.cpp.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void rot_enc_dump_trace(rot_enc_handle_t *handle_ptr)
+{
+  uint8_t id = handle_ptr->id;
+
+  trace_paused[id] = true;
+  __DMB();
+
+  // Entries older than the depth have been overwritten.
+  uint32_t count = trace_count[id];
+  uint32_t kept = (count > ROT_ENC_TRACE_DEPTH) ? ROT_ENC_TRACE_DEPTH : count;
+
+  log_message_with_unsigned_val(&log_rot_enc, INFO,
+                                "trace encoder id =", id, DECIMAL);
+  log_message_with_unsigned_val(&log_rot_enc, INFO,
+                                "trace resolution =",
+                                handle_ptr->resolution, DECIMAL);
+  log_message_with_unsigned_val(&log_rot_enc, INFO,
+                                "trace recovery =",
+                                handle_ptr->recover_skipped_steps, DECIMAL);
+  log_message_with_unsigned_val(&log_rot_enc, INFO,
+                                "trace dropped =",
+                                (count - kept) + trace_dropped[id], DECIMAL);
+  log_message_with_unsigned_val(&log_rot_enc, INFO,
+                                "trace entries =", kept, DECIMAL);
+
+  for (uint32_t index = count - kept; index != count; ++index)
+  {
+    log_message_with_unsigned_val(&log_rot_enc, INFO, "trace entry =",
+                                  trace_buffer[id]
+                                              [index &
+                                               (ROT_ENC_TRACE_DEPTH - 1U)],
+                                  HEXADECIMAL);
+  }
+
+  uint32_t primask = rot_enc_enter_critical();
+  trace_count[id] = 0;
+  trace_dropped[id] = 0;
+  trace_paused[id] = false;
+  rot_enc_exit_critical(primask);
+}
+#endif
+
+
+#if ROT_ENC_EVENT_QUEUE_SIZE > 0
+/*
+ * Copies queued encoder events, oldest first, and removes them from the
+ * queue. Call this from the main loop only. The queue is single-producer,
+ * so all encoder EXTI and polling interrupts must share one priority.
+ * @param takes a pointer to an array to copy events into.
+ * @param takes the maximum number of events to copy.
+ * @return the number of events copied.
+ */
+uint16_t rot_enc_drain_events(rot_enc_event_t *events, uint16_t max_events)
+{
+  uint16_t tail = event_queue_tail;
+  uint16_t head = event_queue_head;
+  uint16_t count = 0;
+
+  while (tail != head && count < max_events)
+  {
+    events[count] = event_queue[tail];
+    tail = (tail + 1U) & (ROT_ENC_EVENT_QUEUE_SIZE - 1U);
+    ++count;
+  }
+
+  // Make sure the entries have been read before handing the slots back.
+  __DMB();
+  event_queue_tail = tail;
+
+  return count;
+}
+
+
+/*
+ * @return the number of events discarded because the queue was full.
+ */
+uint32_t rot_enc_get_dropped_event_count(void)
+{
+  return dropped_events;
+}
+#endif
+
+
+// ------------------------------------------------------------------------- //
+// ------------------------- Private Utility Functions --------------------- //
+// ------------------------------------------------------------------------- //
+
+
+/**
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return digital state of pins A and B from inside handle struct, as a 2 bit
+ * number.
+ */
+uint8_t get_state(rot_enc_handle_t *handle_ptr)
+{
+  uint8_t temp = 0;
+
+  if (handle_ptr->same_port)
+  {
+    // Sample both pins with one read of the input data register, so A and B
+    // cannot change between reads.
+    uint32_t idr = rot_enc_port_read(handle_ptr->port_a);
+    temp = ((idr >> handle_ptr->shift_a) & 1U) << 1;
+    temp |= (idr >> handle_ptr->shift_b) & 1U;
+  }
+  else
+  {
+    // Pack Pin_A and Pin_B values into a single variable 0b000000AB.
+    temp = rot_enc_port_read_pin(handle_ptr->port_a, handle_ptr->pin_a) << 1;
+    temp |= rot_enc_port_read_pin(handle_ptr->port_b, handle_ptr->pin_b);
+  }
+  return temp; 
+}
+
+
+/**
+ * @param takes a GPIO pin mask (GPIO_PIN_0 to GPIO_PIN_15).
+ * @return the bit position of the pin within the port registers.
+ */
+uint8_t pin_to_shift(uint16_t pin)
+{
+  uint8_t shift = 0;
+
+  while (pin > 1U)
+  {
+    pin >>= 1;
+    ++shift;
+  }
+  return shift;
+}
+
+
+/**
+ * @param takes the GPIO pin number that triggered the interrupt.
+ * @return pointer to the handle struct of the encoder that triggered the
+ * interrupt.
+ */ 
+rot_enc_handle_t* determine_trigger(uint16_t GPIO_Pin)
+{
+  rot_enc_handle_t *handle_ptr = NULL;
+
+  for (int index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    if (registered_handles[index] == NULL)
+    {
+      continue;
+    }
+
+    if (registered_handles[index]->pin_a == GPIO_Pin ||
+        registered_handles[index]->pin_b == GPIO_Pin ||
+        registered_handles[index]->button_pin == GPIO_Pin ||
+        registered_handles[index]->index_pin == GPIO_Pin)
+    {
+      handle_ptr = registered_handles[index];
+      break;
+    }
+  }
+  return handle_ptr;
+}
+
+
+/**
+ * Decodes the phase transition from the encoder, and stores the new state.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void decode_phase_transition(rot_enc_handle_t *handle_ptr)
+{
+  // Get new pin states. 
+  rot_enc_update_state(handle_ptr, get_state(handle_ptr));
+}
+
+
+/**
+ * Runs a transition through the state machine table, and edits the counter
+ * ONLY if the transition is valid and completes a count.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the 4 bit transition value, old state << 2 | new state.
+ */
+void process_transition(rot_enc_handle_t *handle_ptr, uint8_t transition)
+{
+  uint8_t entry = rot_enc_state_table[handle_ptr->resolution]
+                                     [handle_ptr->detent_state]
+                                     [transition];
+  handle_ptr->detent_state = ROT_ENC_STATE_NEXT(entry);
+
+  // (step = 0 if invalid.)
+  int8_t step = ROT_ENC_STATE_STEP(entry);
+  if (step != 0)
+  {
+    uint32_t now = ROT_ENC_GET_TIMESTAMP();
+    record_edge(handle_ptr, step, now);
+
+    int8_t count = ROT_ENC_STATE_COUNT(entry);
+    if (count != 0)
+    {
+      update_counter(handle_ptr, count, now);
+    }
+  }
+  else if (ROT_ENC_STATE_DOUBLE(entry))
+  {
+    ++handle_ptr->stats.invalid_transitions;
+
+    // A step was missed. Assume the encoder kept turning the same way, and
+    // replay the transition as two single steps via the missing state.
+    if (handle_ptr->recover_skipped_steps && handle_ptr->last_step != 0)
+    {
+      uint8_t old_state = transition >> 2;
+      uint8_t new_state = transition & 0x03U;
+      uint8_t missed_state =
+        rot_enc_next_state[handle_ptr->last_step > 0][old_state];
+
+      process_transition(handle_ptr, (old_state << 2) | missed_state);
+      process_transition(handle_ptr, (missed_state << 2) | new_state);
+    }
+  }
+  else
+  {
+    // Interrupt fired, but the pins are back where they were.
+    ++handle_ptr->stats.bounces;
+  }
+}
+
+
+/**
+ * Adds a count to the counter, scaled by the acceleration curve if enabled,
+ * and applies the count mode at counter_min and counter_max.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the count to apply, -1 or 1 (or more from the timer backend).
+ * @param takes the timestamp of the transition.
+ */
+void update_counter(rot_enc_handle_t *handle_ptr, int32_t step, uint32_t now)
+{
+  rot_enc_count_t previous_count = handle_ptr->counter;
+  rot_enc_wide_count_t delta = step;
+
+  // Scale the step up if the encoder is being spun quickly.
+  if (handle_ptr->accel_enabled)
+  {
+    delta *= get_accel_multiplier(handle_ptr,
+                                  now - handle_ptr->last_count_time);
+  }
+  handle_ptr->last_count_time = now;
+
+  // Scale the step, carrying any fraction over to the next count.
+  if (handle_ptr->step_multiplier != 0 || handle_ptr->step_divisor != 0)
+  {
+    delta = scale_step(handle_ptr, delta);
+  }
+
+  rot_enc_wide_count_t count;
+#if ROT_ENC_COUNTER_BITS == 64
+  // There is no wider type, so a sum past the limits of int64_t saturates
+  // there, or wraps round when unbounded.
+  if (__builtin_add_overflow(previous_count, delta, &count))
+  {
+    count = (handle_ptr->count_mode == ROT_ENC_UNBOUNDED) ?
+            (rot_enc_wide_count_t)((uint64_t)previous_count + (uint64_t)delta) :
+            ((delta > 0) ? INT64_MAX : INT64_MIN);
+  }
+#else
+  count = (rot_enc_wide_count_t)previous_count + delta;
+#endif
+
+  // The change reported to the event queue is the step as applied, before
+  // any wrap, so the queued deltas follow the travel of the encoder.
+  rot_enc_wide_count_t applied = delta;
+
+  if (handle_ptr->count_mode == ROT_ENC_SATURATE)
+  {
+    // Drop the carried fraction at the limits, so turning back moves the
+    // counter off the limit straight away.
+    if (count > handle_ptr->counter_max || count < handle_ptr->counter_min)
+    {
+      handle_ptr->step_remainder = 0;
+    }
+
+    // Confine the counter within its limits. Written as selects rather than
+    // an if/else chain, so the compiler can use conditional execution.
+    count = (count > handle_ptr->counter_max) ? handle_ptr->counter_max : count;
+    count = (count < handle_ptr->counter_min) ? handle_ptr->counter_min : count;
+    applied = count - previous_count;
+  }
+  else if (handle_ptr->count_mode == ROT_ENC_WRAP)
+  {
+    count = wrap_count(handle_ptr, count);
+  }
+  handle_ptr->counter = (rot_enc_count_t)count;
+
+  if (handle_ptr->counter != previous_count)
+  {
+    notify_change(handle_ptr, (int32_t)applied, now);
+  }
+}
+
+
+/**
+ * Wraps a count that has passed counter_max or counter_min back into range.
+ * A single add or subtract covers steps smaller than the range; the modulo
+ * is only needed for larger accelerated steps.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the count after the step was added.
+ * @return the count, wrapped into counter_min to counter_max.
+ */
+rot_enc_wide_count_t wrap_count(rot_enc_handle_t *handle_ptr,
+                                rot_enc_wide_count_t count)
+{
+  rot_enc_wide_count_t max = handle_ptr->counter_max;
+  rot_enc_wide_count_t min = handle_ptr->counter_min;
+  rot_enc_wide_count_t range = max - min + 1;
+
+  if (count > max)
+  {
+    count -= range;
+    if (count > max)
+    {
+      count = min + ((count - min) % range);
+    }
+  }
+  else if (count < min)
+  {
+    count += range;
+    if (count < min)
+    {
+      count = max - ((max - count) % range);
+    }
+  }
+  return count;
+}
+
+
+/**
+ * Looks up the step multiplier for the time since the previous count.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the time since the previous count, in timestamp ticks.
+ * @return the multiplier from the first matching curve entry, or 1 if the
+ * encoder is turning slower than every entry.
+ */
+uint16_t get_accel_multiplier(rot_enc_handle_t *handle_ptr, uint32_t interval)
+{
+  for (uint8_t index = 0; index < handle_ptr->accel_curve_len; ++index)
+  {
+    if (interval <= handle_ptr->accel_curve[index].max_interval)
+    {
+      return handle_ptr->accel_curve[index].multiplier;
+    }
+  }
+  return 1;
+}
+
+
+/**
+ * Scales a step by step_multiplier / step_divisor, adding in the fraction
+ * left over from previous steps and keeping the new fraction.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the step to scale.
+ * @return the scaled step, rounded towards zero.
+ */
+rot_enc_wide_count_t scale_step(rot_enc_handle_t *handle_ptr,
+                                rot_enc_wide_count_t delta)
+{
+  rot_enc_wide_count_t multiplier = (handle_ptr->step_multiplier != 0) ?
+                                    handle_ptr->step_multiplier : 1;
+  rot_enc_wide_count_t divisor = (handle_ptr->step_divisor != 0) ?
+                                 handle_ptr->step_divisor : 1;
+  rot_enc_wide_count_t scaled = delta * multiplier +
+                                handle_ptr->step_remainder;
+
+  // Truncate towards zero, keeping a remainder with the sign of the travel,
+  // so a count takes the same travel in either direction and jitter about
+  // a count does not flicker the counter.
+  handle_ptr->step_remainder = (int32_t)(scaled % divisor);
+
+  return scaled / divisor;
+}
+
+
+/**
+ * Marks the encoder as changed in the dirty mask, and queues the change as
+ * an event.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the change applied to the counter.
+ * @param takes the timestamp of the change.
+ */
+void notify_change(rot_enc_handle_t *handle_ptr, int32_t delta, uint32_t now)
+{
+  dirty_mask |= 1UL << handle_ptr->id;
+  queue_event(handle_ptr, delta, now);
+}
+
+
+/**
+ * Adds a timestamped event to the queue, or counts it as dropped if the
+ * queue is full. Does nothing if the queue is disabled.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the change applied to the counter.
+ * @param takes the timestamp of the change.
+ */
+void queue_event(rot_enc_handle_t *handle_ptr, int32_t delta, uint32_t now)
+{
+#if ROT_ENC_EVENT_QUEUE_SIZE > 0
+  uint16_t head = event_queue_head;
+  uint16_t next = (head + 1U) & (ROT_ENC_EVENT_QUEUE_SIZE - 1U);
+
+  if (next == event_queue_tail)
+  {
+    ++dropped_events;
+    return;
+  }
+
+  event_queue[head].timestamp = now;
+  event_queue[head].delta = delta;
+  event_queue[head].encoder_id = handle_ptr->id;
+
+  // Make sure the entry is written before it is published to the consumer.
+  __DMB();
+  event_queue_head = next;
+#else
+  (void)handle_ptr;
+  (void)delta;
+  (void)now;
+#endif
+}
+
+
+/**
+ * Records the timing of a valid transition for velocity estimation. Kept to a
+ * few stores, as it runs in the ISR; the maths is done by
+ * update_motion_estimate().
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the step decoded, -1 or 1.
+ * @param takes the timestamp of the transition.
+ */
+void record_edge(rot_enc_handle_t *handle_ptr, int8_t step, uint32_t now)
+{
+  handle_ptr->edge_period = now - handle_ptr->last_edge_time;
+  handle_ptr->last_edge_time = now;
+  handle_ptr->last_step = step;
+  handle_ptr->position = (int32_t)((uint32_t)handle_ptr->position +
+                                   (uint32_t)(int32_t)step);
+  ++handle_ptr->stats.valid_steps;
+}
+
+
+/**
+ * Recalculates velocity and acceleration from the edges recorded since the
+ * last update. Does nothing until ROT_ENC_VELOCITY_WINDOW has elapsed.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void update_motion_estimate(rot_enc_handle_t *handle_ptr)
+{
+  // Take a consistent copy of the values written by the ISR.
+  uint32_t primask = rot_enc_enter_critical();
+  int32_t position = handle_ptr->position;
+  uint32_t last_edge_time = handle_ptr->last_edge_time;
+  uint32_t edge_period = handle_ptr->edge_period;
+  int8_t last_step = handle_ptr->last_step;
+  uint32_t now = ROT_ENC_GET_TIMESTAMP();
+  rot_enc_exit_critical(primask);
+
+  uint32_t elapsed = now - handle_ptr->sample_time;
+  if (elapsed < ROT_ENC_VELOCITY_WINDOW || elapsed == 0)
+  {
+    return;
+  }
+
+  int32_t counts = (int32_t)((uint32_t)position -
+                             (uint32_t)handle_ptr->sample_position);
+  int32_t velocity = 0;
+
+  if (counts >= ROT_ENC_VELOCITY_MIN_COUNTS ||
+      counts <= -ROT_ENC_VELOCITY_MIN_COUNTS)
+  {
+    // High speed, count transitions over the window.
+    velocity = (int32_t)(((int64_t)counts * ROT_ENC_TIMESTAMP_HZ) /
+                         (int64_t)elapsed);
+  }
+  else
+  {
+    // Low speed, measure the period between edges. If the next edge is
+    // overdue, the shaft is slowing, so use the time since the last edge.
+    uint32_t since_edge = now - last_edge_time;
+
+    if (since_edge < ROT_ENC_VELOCITY_TIMEOUT)
+    {
+      uint32_t period = (since_edge > edge_period) ? since_edge : edge_period;
+      if (period == 0)
+      {
+        period = 1;
+      }
+      velocity = (int32_t)(((int64_t)last_step * ROT_ENC_TIMESTAMP_HZ) /
+                           (int64_t)period);
+    }
+  }
+
+  // Differentiate velocity, then low pass filter the result.
+  int32_t acceleration = (int32_t)(((int64_t)(velocity -
+                                              handle_ptr->velocity) *
+                                    ROT_ENC_TIMESTAMP_HZ) / (int64_t)elapsed);
+  handle_ptr->acceleration += (acceleration - handle_ptr->acceleration) /
+                              (1 << ROT_ENC_ACCEL_FILTER_SHIFT);
+
+  handle_ptr->velocity = velocity;
+  handle_ptr->sample_position = position;
+  handle_ptr->sample_time = now;
+}
+
+
+/**
+ * Latches the counter on the rising edge of an index pulse, counts the
+ * revolution in the direction of travel, and zeroes the counter if
+ * index_auto_zero is set. The count mode's limits still apply, so a range
+ * that excludes 0 homes to its nearest limit.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void latch_index(rot_enc_handle_t *handle_ptr)
+{
+  // Only the rising edge marks the index position.
+  if (handle_ptr->index_port != NULL &&
+      rot_enc_port_read_pin(handle_ptr->index_port, handle_ptr->index_pin) !=
+      GPIO_PIN_SET)
+  {
+    return;
+  }
+
+  // Bring a timer backed count up to date before latching it.
+  if (handle_ptr->timer != NULL)
+  {
+    sync_timer_backend(handle_ptr);
+  }
+
+  handle_ptr->index_position = handle_ptr->counter;
+  handle_ptr->revolutions += (handle_ptr->last_step < 0) ? -1 : 1;
+  handle_ptr->index_seen = true;
+
+  // Home to 0, or to the nearest limit if 0 is outside counter_min and
+  // counter_max.
+  if (handle_ptr->index_auto_zero)
+  {
+    rot_enc_count_t home = 0;
+    if (handle_ptr->count_mode != ROT_ENC_UNBOUNDED)
+    {
+      home = (home > handle_ptr->counter_max) ? handle_ptr->counter_max : home;
+      home = (home < handle_ptr->counter_min) ? handle_ptr->counter_min : home;
+    }
+    set_counter(handle_ptr, home);
+  }
+}
+
+
+/**
+ * Debounces a button, and runs the gesture state machine. A change in pin
+ * level must be stable for ROT_ENC_DEBOUNCE_MS before it is accepted.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the current time in milliseconds.
+ */
+void update_button(rot_enc_handle_t *handle_ptr, uint32_t now)
+{
+  rot_enc_button_state_t *button_ptr = &handle_ptr->button;
+  bool raw_pressed = (rot_enc_port_read_pin(handle_ptr->button_port,
+                                            handle_ptr->button_pin) ==
+                      handle_ptr->button_pressed_state);
+
+  // Restart the debounce timer on every change in pin level.
+  if (raw_pressed != button_ptr->raw_pressed)
+  {
+    button_ptr->raw_pressed = raw_pressed;
+    button_ptr->raw_change_time = now;
+  }
+
+  if (raw_pressed != button_ptr->pressed &&
+      now - button_ptr->raw_change_time >= ROT_ENC_DEBOUNCE_MS)
+  {
+    button_ptr->pressed = raw_pressed;
+
+    if (button_ptr->pressed)
+    {
+      button_ptr->press_time = now;
+      button_ptr->long_pressed = false;
+
+      if (handle_ptr->button_action == ROT_ENC_RESET_ON_PRESS)
+      {
+        reset_counter(handle_ptr);
+      }
+    }
+    else if (!button_ptr->long_pressed)
+    {
+      // Released before a long press, so this was a click.
+      button_ptr->release_time = now;
+      ++button_ptr->clicks;
+
+      if (button_ptr->clicks == 2)
+      {
+        button_ptr->clicks = 0;
+        button_event(handle_ptr, ROT_ENC_BUTTON_DOUBLE_CLICK);
+
+        if (handle_ptr->button_action == ROT_ENC_RESET_ON_DOUBLE_CLICK)
+        {
+          reset_counter(handle_ptr);
+        }
+      }
+    }
+  }
+
+  if (button_ptr->pressed)
+  {
+    if (!button_ptr->long_pressed &&
+        now - button_ptr->press_time >= ROT_ENC_LONG_PRESS_MS)
+    {
+      button_ptr->long_pressed = true;
+
+      // A click just before this press has not been reported yet.
+      if (button_ptr->clicks != 0)
+      {
+        button_click(handle_ptr);
+      }
+      button_ptr->next_repeat_time = now + ROT_ENC_HOLD_REPEAT_MS;
+      button_event(handle_ptr, ROT_ENC_BUTTON_LONG_PRESS);
+
+      if (handle_ptr->button_action == ROT_ENC_RESET_ON_LONG_PRESS)
+      {
+        reset_counter(handle_ptr);
+      }
+    }
+    else if (button_ptr->long_pressed &&
+             (int32_t)(now - button_ptr->next_repeat_time) >= 0)
+    {
+      button_ptr->next_repeat_time += ROT_ENC_HOLD_REPEAT_MS;
+      button_event(handle_ptr, ROT_ENC_BUTTON_HOLD_REPEAT);
+    }
+  }
+  else if (button_ptr->clicks == 1 &&
+           now - button_ptr->release_time >= ROT_ENC_DOUBLE_CLICK_MS)
+  {
+    // No second click arrived in time.
+    button_click(handle_ptr);
+  }
+}
+
+
+/**
+ * Reports a single click, once no second click can follow it.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void button_click(rot_enc_handle_t *handle_ptr)
+{
+  handle_ptr->button.clicks = 0;
+  button_event(handle_ptr, ROT_ENC_BUTTON_CLICK);
+
+  if (handle_ptr->button_action == ROT_ENC_RESET_ON_CLICK)
+  {
+    reset_counter(handle_ptr);
+  }
+}
+
+
+/**
+ * Adds a button event to the queue. The event is dropped if the queue is
+ * full.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the type of event.
+ */
+void button_event(rot_enc_handle_t *handle_ptr,
+                  rot_enc_button_event_type_t type)
+{
+  uint8_t head = button_queue_head;
+  uint8_t next = (head + 1U) & (ROT_ENC_BUTTON_QUEUE_SIZE - 1U);
+
+  if (next == button_queue_tail)
+  {
+    return;
+  }
+
+  button_queue[head].encoder_id = handle_ptr->id;
+  button_queue[head].type = type;
+
+  // Make sure the entry is written before it is published to the consumer.
+  __DMB();
+  button_queue_head = next;
+}
+
+
+/**
+ * Resets the counter to reset_value, queueing the change as an event.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void reset_counter(rot_enc_handle_t *handle_ptr)
+{
+  set_counter(handle_ptr, handle_ptr->reset_value);
+}
+
+
+/**
+ * Sets the counter to a new value, queueing the change as an event.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the new counter value.
+ */
+void set_counter(rot_enc_handle_t *handle_ptr, rot_enc_count_t value)
+{
+  rot_enc_count_t previous_count = handle_ptr->counter;
+
+  handle_ptr->counter = value;
+  handle_ptr->step_remainder = 0;
+
+  if (handle_ptr->counter != previous_count)
+  {
+    notify_change(handle_ptr,
+                  (int32_t)((rot_enc_wide_count_t)handle_ptr->counter -
+                            previous_count),
+                  ROT_ENC_GET_TIMESTAMP());
+  }
+}
+
+
+/**
+ * Counts an edge towards the current rate window. If the edge rate exceeds
+ * storm_threshold, masks the encoder's EXTI lines so rot_enc_tick() polls
+ * the pins instead.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return true if a storm was detected, false if not.
+ */
+bool detect_storm(rot_enc_handle_t *handle_ptr)
+{
+  uint32_t now = ROT_ENC_GET_TIMESTAMP();
+
+  if (now - handle_ptr->storm_window_start >= ROT_ENC_STORM_WINDOW)
+  {
+    handle_ptr->storm_window_start = now;
+    handle_ptr->storm_edges = 0;
+  }
+
+  if (++handle_ptr->storm_edges <= handle_ptr->storm_threshold)
+  {
+    return false;
+  }
+
+  // EXTI line numbers match pin numbers, so the pin masks select the lines.
+  EXTI->IMR &= ~((uint32_t)handle_ptr->pin_a | handle_ptr->pin_b);
+  handle_ptr->storm_active = true;
+  handle_ptr->storm_quiet_since = HAL_GetTick();
+  ++handle_ptr->stats.storms;
+
+  return true;
+}
+
+
+/**
+ * Polls an encoder whose EXTI lines are masked, and unmasks them once the
+ * pins have been stable for ROT_ENC_STORM_HOLDOFF_MS.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the current time in milliseconds.
+ */
+void poll_storm(rot_enc_handle_t *handle_ptr, uint32_t now)
+{
+  uint8_t state = get_state(handle_ptr);
+
+  if (state != handle_ptr->old_state)
+  {
+    rot_enc_update_state(handle_ptr, state);
+    handle_ptr->storm_quiet_since = now;
+  }
+  else if (now - handle_ptr->storm_quiet_since >= ROT_ENC_STORM_HOLDOFF_MS)
+  {
+    uint32_t lines = (uint32_t)handle_ptr->pin_a | handle_ptr->pin_b;
+
+    // Discard edges latched while masked, then re-enable the interrupts.
+    EXTI->PR = lines;
+    handle_ptr->storm_active = false;
+    handle_ptr->storm_edges = 0;
+    handle_ptr->storm_window_start = ROT_ENC_GET_TIMESTAMP();
+    EXTI->IMR |= lines;
+  }
+}
+
+
+/**
+ * Reads a timer backed encoder's CNT register, and extends it to 32 bits by
+ * accumulating the signed difference from the last read. Must be called more
+ * often than the timer can count through half its range, which
+ * rot_enc_tick() ensures. The new transitions are then applied to the counter
+ * at the handle's resolution, counting at multiples of the transitions per
+ * count from where the timer started.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void sync_timer_backend(rot_enc_handle_t *handle_ptr)
+{
+  // Called from both the tick and main loop, so keep them apart.
+  uint32_t primask = rot_enc_enter_critical();
+
+  uint32_t cnt = handle_ptr->timer->CNT;
+  int32_t delta;
+
+  if (handle_ptr->timer->ARR <= 0xFFFFU)
+  {
+    delta = (int16_t)(uint16_t)(cnt - handle_ptr->timer_last_cnt);
+  }
+  else
+  {
+    delta = (int32_t)(cnt - handle_ptr->timer_last_cnt);
+  }
+  handle_ptr->timer_last_cnt = cnt;
+
+  if (delta != 0)
+  {
+    uint32_t now = ROT_ENC_GET_TIMESTAMP();
+    uint32_t transitions = (delta > 0) ? (uint32_t)delta : (uint32_t)-delta;
+
+    record_transitions(handle_ptr, delta, transitions, now);
+
+    // 1, 2 or 4 transitions per count, for 4x, 2x and 1x resolution. The
+    // remainder carries part counts between reads, so the position itself
+    // is free to wrap.
+    int32_t per_count = 1 << handle_ptr->resolution;
+    int32_t residue = handle_ptr->timer_residue + delta;
+    int32_t count = floor_div(residue, per_count);
+    handle_ptr->timer_residue = residue - (count * per_count);
+    if (count != 0)
+    {
+      update_counter(handle_ptr, count, now);
+    }
+  }
+
+  rot_enc_exit_critical(primask);
+}
+
+
+/**
+ * Records a batch of valid transitions decoded together, by the timer backend
+ * or from DMA samples, for velocity estimation and statistics. The time since
+ * the last batch is spread evenly across the transitions.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the net number of steps, positive when incrementing.
+ * @param takes the total number of valid transitions in the batch.
+ * @param takes the timestamp of the batch.
+ */
+void record_transitions(rot_enc_handle_t *handle_ptr,
+                        int32_t net_steps,
+                        uint32_t transitions,
+                        uint32_t now)
+{
+  if (transitions == 0)
+  {
+    return;
+  }
+
+  handle_ptr->edge_period = (now - handle_ptr->last_edge_time) / transitions;
+  handle_ptr->last_edge_time = now;
+  if (net_steps != 0)
+  {
+    handle_ptr->last_step = (net_steps > 0) ? 1 : -1;
+  }
+  handle_ptr->position = (int32_t)((uint32_t)handle_ptr->position +
+                                   (uint32_t)net_steps);
+  handle_ptr->stats.valid_steps += transitions;
+}
+
+
+/**
+ * Looks up a counter value in a map, and interpolates between the points
+ * either side of it.
+ * @param takes a pointer to a rot_enc_map_t object.
+ * @param takes the counter value to map.
+ * @return the mapped value.
+ */
+int32_t map_value(const rot_enc_map_t *map_ptr, rot_enc_count_t count)
+{
+  uint16_t last = map_ptr->num_of_points - 1U;
+  int64_t x0;
+  int64_t x1;
+  uint16_t index;
+
+  if (map_ptr->inputs == NULL)
+  {
+    // Evenly spaced, so the segment is found by division.
+    int64_t offset = (int64_t)count - map_ptr->input_min;
+    if (offset <= 0)
+    {
+      return map_ptr->outputs[0];
+    }
+    if (offset >= (int64_t)last * map_ptr->input_step)
+    {
+      return map_ptr->outputs[last];
+    }
+    index = (uint16_t)(offset / map_ptr->input_step);
+    x0 = (int64_t)map_ptr->input_min + (int64_t)index * map_ptr->input_step;
+    x1 = x0 + map_ptr->input_step;
+  }
+  else
+  {
+    if (count <= map_ptr->inputs[0])
+    {
+      return map_ptr->outputs[0];
+    }
+    if (count >= map_ptr->inputs[last])
+    {
+      return map_ptr->outputs[last];
+    }
+
+    // Binary search for the segment with inputs[index] <= count.
+    uint16_t low = 0;
+    uint16_t high = last;
+    while (high - low > 1)
+    {
+      uint16_t mid = (uint16_t)((low + high) / 2U);
+      if (map_ptr->inputs[mid] <= count)
+      {
+        low = mid;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+    index = low;
+    x0 = map_ptr->inputs[index];
+    x1 = map_ptr->inputs[index + 1U];
+  }
+
+  int64_t y0 = map_ptr->outputs[index];
+  int64_t y1 = map_ptr->outputs[index + 1U];
+
+  return (int32_t)(y0 + ((y1 - y0) * ((int64_t)count - x0)) / (x1 - x0));
+}
+
+
+#if ROT_ENC_TRACE_DEPTH > 0
+/**
+ * Appends a transition to the encoder's trace, overwriting the oldest entry
+ * once full. Kept to a few stores, as it runs in the ISR.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the 4 bit transition value, old state << 2 | new state.
+ */
+void record_trace(rot_enc_handle_t *handle_ptr, uint8_t transition)
+{
+  uint8_t id = handle_ptr->id;
+
+  if (trace_paused[id])
+  {
+    ++trace_dropped[id];
+    return;
+  }
+
+  uint32_t now = ROT_ENC_GET_TIMESTAMP();
+  uint32_t delta = now - trace_last_time[id];
+  trace_last_time[id] = now;
+  delta = (delta > ROT_ENC_TRACE_DELTA_MAX) ? ROT_ENC_TRACE_DELTA_MAX : delta;
+
+  uint32_t count = trace_count[id];
+  trace_buffer[id][count & (ROT_ENC_TRACE_DEPTH - 1U)] =
+    ROT_ENC_TRACE_ENTRY(transition, delta);
+  trace_count[id] = count + 1U;
+}
+#endif
+
+
+/**
+ * Writes a 32 bit value little endian, independent of the host byte order.
+ * @param takes a pointer to the buffer to write to.
+ * @param takes the value to write.
+ * @return a pointer to the byte after the value.
+ */
+uint8_t* pack_u32(uint8_t *buffer, uint32_t value)
+{
+  buffer[0] = (uint8_t)value;
+  buffer[1] = (uint8_t)(value >> 8);
+  buffer[2] = (uint8_t)(value >> 16);
+  buffer[3] = (uint8_t)(value >> 24);
+  return buffer + 4;
+}
+
+
+/**
+ * Restores the counter from the store, confined to counter_min and
+ * counter_max unless the count mode is unbounded.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void restore_position(rot_enc_handle_t *handle_ptr)
+{
+  rot_enc_count_t value;
+
+  if (position_store->read(handle_ptr->id, &value))
+  {
+    if (handle_ptr->count_mode != ROT_ENC_UNBOUNDED)
+    {
+      value = (value > handle_ptr->counter_max) ? handle_ptr->counter_max : value;
+      value = (value < handle_ptr->counter_min) ? handle_ptr->counter_min : value;
+    }
+
+    uint32_t primask = rot_enc_enter_critical();
+    handle_ptr->counter = value;
+    rot_enc_exit_critical(primask);
+  }
+
+  handle_ptr->persist_value = handle_ptr->counter;
+  handle_ptr->persist_candidate = handle_ptr->counter;
+}
+
+
+/**
+ * @param takes the value to divide.
+ * @param takes a positive divisor.
+ * @return the quotient, rounded towards negative infinity.
+ */
+int32_t floor_div(int32_t value, int32_t divisor)
+{
+  int32_t quotient = value / divisor;
+
+  if ((value % divisor) != 0 && value < 0)
+  {
+    --quotient;
+  }
+  return quotient;
+}
+
+
+/**
+ * Disables interrupts, for short sections shared with the ISR.
+ * @return the previous interrupt mask, to pass to rot_enc_exit_critical().
+ */
+uint32_t rot_enc_enter_critical(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+
+
+/**
+ * Restores interrupts to their state before rot_enc_enter_critical().
+ * @param takes the interrupt mask returned by rot_enc_enter_critical().
+ */
+void rot_enc_exit_critical(uint32_t primask)
+{
+  __set_PRIMASK(primask);
 }
 
 
@@ -260,19 +2026,19 @@ void print_debug_info(rot_enc_handle_t *handle_ptr)
     log_message_with_signed_val(&log_rot_enc,
                                   DEBUG,
                                   "handle_ptr->counter =",
-                                  handle_ptr->counter,
+                                  (int32_t)handle_ptr->counter,
                                   DECIMAL);
 
     log_message_with_signed_val(&log_rot_enc,
                                   DEBUG,
                                   "handle_ptr->counter_max =",
-                                  handle_ptr->counter_max,
+                                  (int32_t)handle_ptr->counter_max,
                                   DECIMAL);
 
     log_message_with_signed_val(&log_rot_enc,
                                   DEBUG,
                                   "handle_ptr->counter_min =",
-                                  handle_ptr->counter_min,
+                                  (int32_t)handle_ptr->counter_min,
                                   DECIMAL);
 
     log_message_with_unsigned_val(&log_rot_enc,
@@ -26,8 +26,8 @@
  * @author Jason Duffy
  * @date 30th September 2022
  * @brief Algorithms for incremental encoder decoding, with rejection of
- * invalid signals, for the STM32f4xx HAL. Upto 5 incremental encoders with
- * push button can be used.
+ * invalid signals, for the STM32f4xx HAL. Upto MAX_NUM_OF_ENCODERS (5 by
+ * default) incremental encoders with push button can be used.
  */
 
 #ifndef ROTARY_ENCODER_DOT_H
@@ -37,11 +37,341 @@
 #include <stdint.h>
 #include "gpio.h"
 
+/**
+ * Maximum number of encoders that can be registered. Define this in your
+ * build flags to override the default.
+ */
+#ifndef MAX_NUM_OF_ENCODERS
+#define MAX_NUM_OF_ENCODERS   5
+#endif
+
+/**
+ * Width of the encoder counters in bits, 16, 32 or 64. Defaults to 16. Wider
+ * counters suit high resolution encoders in motion applications.
+ */
+#ifndef ROT_ENC_COUNTER_BITS
+#define ROT_ENC_COUNTER_BITS  16
+#endif
+
+#if ROT_ENC_COUNTER_BITS == 16
+typedef int16_t rot_enc_count_t;
+#elif ROT_ENC_COUNTER_BITS == 32
+typedef int32_t rot_enc_count_t;
+#elif ROT_ENC_COUNTER_BITS == 64
+typedef int64_t rot_enc_count_t;
+#else
+#error "ROT_ENC_COUNTER_BITS must be 16, 32 or 64"
+#endif
+
+/**
+ * Timestamp source for encoder events, and its tick rate in Hz. Defaults to
+ * the HAL millisecond tick. Define these in your build flags to use a faster
+ * free-running counter, such as the DWT cycle counter or a 32 bit timer.
+ */
+#ifndef ROT_ENC_GET_TIMESTAMP
+#define ROT_ENC_GET_TIMESTAMP()   HAL_GetTick()
+#endif
+
+#ifndef ROT_ENC_TIMESTAMP_HZ
+#define ROT_ENC_TIMESTAMP_HZ      1000U
+#endif
+
+/**
+ * Number of entries in the shared encoder event queue, must be a power of 2.
+ * The queue is disabled by default; define a size in your build flags to
+ * enable it.
+ */
+#ifndef ROT_ENC_EVENT_QUEUE_SIZE
+#define ROT_ENC_EVENT_QUEUE_SIZE  0
+#endif
+
+/**
+ * Button timing in milliseconds, for debounced buttons sampled by
+ * rot_enc_tick().
+ */
+#ifndef ROT_ENC_DEBOUNCE_MS
+#define ROT_ENC_DEBOUNCE_MS           20U
+#endif
+
+#ifndef ROT_ENC_DOUBLE_CLICK_MS
+#define ROT_ENC_DOUBLE_CLICK_MS       300U
+#endif
+
+#ifndef ROT_ENC_LONG_PRESS_MS
+#define ROT_ENC_LONG_PRESS_MS         800U
+#endif
+
+#ifndef ROT_ENC_HOLD_REPEAT_MS
+#define ROT_ENC_HOLD_REPEAT_MS        200U
+#endif
+
+/**
+ * Interrupt storm protection. Edges are counted over ROT_ENC_STORM_WINDOW
+ * timestamp ticks; above a handle's storm_threshold its EXTI lines are masked
+ * and rot_enc_tick() polls the pins instead. Interrupts are re-enabled once
+ * the pins have been stable for ROT_ENC_STORM_HOLDOFF_MS.
+ */
+#ifndef ROT_ENC_STORM_WINDOW
+#define ROT_ENC_STORM_WINDOW          (ROT_ENC_TIMESTAMP_HZ / 100U)
+#endif
+
+#ifndef ROT_ENC_STORM_HOLDOFF_MS
+#define ROT_ENC_STORM_HOLDOFF_MS      50U
+#endif
+
+/**
+ * Number of entries in the shared button event queue, must be a power of 2.
+ */
+#ifndef ROT_ENC_BUTTON_QUEUE_SIZE
+#define ROT_ENC_BUTTON_QUEUE_SIZE     8
+#endif
+
+/**
+ * Velocity estimation tuning, in timestamp ticks and transitions.
+ * Velocity is recalculated at most once per window. If at least
+ * ROT_ENC_VELOCITY_MIN_COUNTS transitions occured in the window they are
+ * counted, otherwise the period between the last two edges is measured.
+ * With no edge for ROT_ENC_VELOCITY_TIMEOUT the encoder is treated as stopped.
+ * Acceleration is low pass filtered, with a time constant of
+ * 2^ROT_ENC_ACCEL_FILTER_SHIFT windows.
+ */
+#ifndef ROT_ENC_VELOCITY_WINDOW
+#define ROT_ENC_VELOCITY_WINDOW       (ROT_ENC_TIMESTAMP_HZ / 50U)
+#endif
+
+#ifndef ROT_ENC_VELOCITY_MIN_COUNTS
+#define ROT_ENC_VELOCITY_MIN_COUNTS   4
+#endif
+
+#ifndef ROT_ENC_VELOCITY_TIMEOUT
+#define ROT_ENC_VELOCITY_TIMEOUT      (ROT_ENC_TIMESTAMP_HZ / 2U)
+#endif
+
+#ifndef ROT_ENC_ACCEL_FILTER_SHIFT
+#define ROT_ENC_ACCEL_FILTER_SHIFT    2
+#endif
+
+/**
+ * Number of raw transitions kept per encoder by the trace recorder, for
+ * debugging missed steps. 0 (default) disables it. Must be a power of 2 when
+ * enabled, and costs 4 bytes per entry per encoder. EXTI transitions are
+ * traced, including those polled by rot_enc_tick() during an interrupt
+ * storm. Transitions decoded by the bank and timer backends, and by
+ * rot_enc_decode_samples(), are not traced.
+ */
+#ifndef ROT_ENC_TRACE_DEPTH
+#define ROT_ENC_TRACE_DEPTH           0
+#endif
+
+/**
+ * Default period in ms between telemetry frames sent by
+ * rot_enc_publish_telemetry(), 0 to disable them. Can be changed at runtime
+ * with rot_enc_set_telemetry_period().
+ */
+#ifndef ROT_ENC_TELEMETRY_PERIOD_MS
+#define ROT_ENC_TELEMETRY_PERIOD_MS   100U
+#endif
+
+/**
+ * Log system frame type of encoder telemetry frames.
+ */
+#ifndef ROT_ENC_TELEMETRY_FRAME_TYPE
+#define ROT_ENC_TELEMETRY_FRAME_TYPE  0x52
+#endif
+
+/**
+ * Time in ms a persisted counter must hold still before rot_enc_save_positions()
+ * writes it to the store. Keeps flash wear down while an encoder is turning.
+ */
+#ifndef ROT_ENC_PERSIST_DELAY_MS
+#define ROT_ENC_PERSIST_DELAY_MS      1000U
+#endif
+
+/**
+ * Enumerated constants for how the counter behaves at its limits.
+ */
+typedef enum
+{
+    // Stop at counter_min and counter_max (default).
+    ROT_ENC_SATURATE,
+
+    // Wrap from counter_max round to counter_min, and vice versa.
+    ROT_ENC_WRAP,
+
+    // Ignore counter_min and counter_max, wrapping only at the limits of
+    // rot_enc_count_t.
+    ROT_ENC_UNBOUNDED
+} rot_enc_count_mode_t;
+
+
+/**
+ * Enumerated constants for the number of counts per quadrature cycle. Use 1x
+ * for encoders with one detent per cycle, so each click counts once.
+ */
+typedef enum
+{
+    // Count every transition (default).
+    ROT_ENC_RESOLUTION_4X,
+
+    // Count at states 0b00 and 0b11.
+    ROT_ENC_RESOLUTION_2X,
+
+    // Count at state 0b00 only.
+    ROT_ENC_RESOLUTION_1X
+} rot_enc_resolution_t;
+
+
+/**
+ * Enumerated constants for the button gesture that resets the counter to
+ * reset_value.
+ */
+typedef enum
+{
+    // Reset as soon as the button is pressed (default).
+    ROT_ENC_RESET_ON_PRESS,
+    ROT_ENC_RESET_ON_CLICK,
+    ROT_ENC_RESET_ON_DOUBLE_CLICK,
+    ROT_ENC_RESET_ON_LONG_PRESS,
+
+    // Never reset, the application handles button events itself.
+    ROT_ENC_RESET_NEVER
+} rot_enc_button_action_t;
+
+
+/**
+ * Enumerated constants for debounced button events.
+ */
+typedef enum
+{
+    // Single press and release, reported once the double click time passes,
+    // or when the next press becomes a long press.
+    ROT_ENC_BUTTON_CLICK,
+    ROT_ENC_BUTTON_DOUBLE_CLICK,
+
+    // Held for ROT_ENC_LONG_PRESS_MS.
+    ROT_ENC_BUTTON_LONG_PRESS,
+
+    // Still held after a long press, repeats every ROT_ENC_HOLD_REPEAT_MS.
+    ROT_ENC_BUTTON_HOLD_REPEAT
+} rot_enc_button_event_type_t;
+
+
+/**
+ * Entry in the button event queue.
+ */
+typedef struct
+{
+    // Registry index of the encoder, see rot_enc_handle_t.
+    uint8_t encoder_id;
+    rot_enc_button_event_type_t type;
+}rot_enc_button_event_t;
+
+
+/**
+ * Debounce and gesture state for a button, managed by rot_enc_tick().
+ */
+typedef struct
+{
+    bool raw_pressed;
+    bool pressed;
+    bool long_pressed;
+    uint8_t clicks;
+    uint32_t raw_change_time;
+    uint32_t press_time;
+    uint32_t release_time;
+    uint32_t next_repeat_time;
+}rot_enc_button_state_t;
+
+
+/**
+ * Entry in an acceleration curve. When the time since the previous count is
+ * no more than max_interval, each step is multiplied by multiplier.
+ * Entries must be sorted by ascending max_interval, e.g.
+ * {{10, 50}, {30, 10}, {80, 4}} with a 1 kHz timestamp.
+ */
+typedef struct
+{
+    // Time since the previous count, in timestamp ticks.
+    uint32_t max_interval;
+    uint16_t multiplier;
+}rot_enc_accel_step_t;
+
+
+/**
+ * Mapping from counter values to output values, e.g. a log curve for volume.
+ * Outputs are linearly interpolated between points, and held at the first
+ * and last output outside the mapped range. Evaluated on read by
+ * rot_enc_get_mapped_value(), never in the ISR.
+ * Leave inputs NULL for a lookup table, with points evenly spaced input_step
+ * apart from input_min, so no search is needed. Otherwise inputs gives the
+ * counter value at each point for piecewise-linear segments of any length.
+ */
+typedef struct
+{
+    // Output value at each point, and the number of points (2 or more).
+    const int32_t *outputs;
+    uint16_t num_of_points;
+
+    // Counter value at each point in ascending order, or NULL.
+    const rot_enc_count_t *inputs;
+
+    // Counter value of the first point, and spacing, when inputs is NULL. A
+    // spacing of 0 steps from the first output to the last at input_min.
+    rot_enc_count_t input_min;
+    rot_enc_count_t input_step;
+}rot_enc_map_t;
+
+
+/**
+ * Non-volatile store for counter values, e.g. backup registers or flash, see
+ * rot_enc_set_store(). Slots are encoder ids, so encoders must be initialised
+ * in the same order on every boot.
+ */
+typedef struct
+{
+    // Reads a slot into *value_ptr, returning false if it holds no value.
+    bool (*read)(uint8_t slot, rot_enc_count_t *value_ptr);
+
+    // Writes a value to a slot.
+    void (*write)(uint8_t slot, rot_enc_count_t value);
+}rot_enc_store_t;
+
+
+/**
+ * Transition statistics for an encoder, to help detect failing hardware and
+ * tune filtering.
+ */
+typedef struct
+{
+    // Transitions where exactly one phase changed.
+    uint32_t valid_steps;
+
+    // Transitions where both phases changed, so a step was missed.
+    uint32_t invalid_transitions;
+
+    // Interrupts where neither phase had changed, usually contact bounce.
+    uint32_t bounces;
+
+    // Times the edge rate exceeded storm_threshold and EXTI was masked.
+    uint32_t storms;
+}rot_enc_stats_t;
+
+
+struct rot_enc_handle;
+
+/**
+ * Change notification, run from rot_enc_process_changes() in the main loop
+ * rather than the ISR.
+ * @param takes a pointer to the handle of the encoder that changed.
+ */
+typedef void (*rot_enc_change_callback_t)(struct rot_enc_handle *handle_ptr);
+
+
 /**
  * Handle struct to store config, pinout and state for each encoder. 
  * Instatiate for each encoder to be used. 
  */
-typedef struct
+typedef struct rot_enc_handle
 {
     // Pinout for encoder wiring. Each pin must be linked to an EXTI interrupt.
     uint16_t pin_a;
@@ -51,17 +381,106 @@ typedef struct
     GPIO_TypeDef *port_b;
 
     // Counter value, initialised to 0 as default. 
-    int16_t counter;
+    rot_enc_count_t counter;
 
     /*
      * Reset value, 0 as default. When button is pushed, counter will be reset
      * to this value.
      */
-    int16_t reset_value;
+    rot_enc_count_t reset_value;
 
     // Min and max values for the counter to be confined to.
-    int16_t counter_max;
-    int16_t counter_min;
+    rot_enc_count_t counter_max;
+    rot_enc_count_t counter_min;
+
+    // Behaviour at counter_min and counter_max, saturate as default.
+    rot_enc_count_mode_t count_mode;
+
+    // Counts per quadrature cycle, 4x as default.
+    rot_enc_resolution_t resolution;
+
+    /*
+     * If true, a transition where both phases changed (a step missed due to
+     * interrupt latency) counts as two steps in the last known direction,
+     * rather than being rejected. Off as default.
+     */
+    bool recover_skipped_steps;
+
+    /*
+     * Optional button port. If set, the button is debounced by rot_enc_tick()
+     * and reports gestures, and its EXTI interrupt is not needed. If NULL, the
+     * counter is reset on every button EXTI interrupt, without debouncing.
+     */
+    GPIO_TypeDef *button_port;
+
+    // Pin level when the button is pressed, GPIO_PIN_RESET (active low) as
+    // default.
+    GPIO_PinState button_pressed_state;
+
+    // Gesture that resets the counter, on press as default.
+    rot_enc_button_action_t button_action;
+
+    /*
+     * Maximum edges per ROT_ENC_STORM_WINDOW before the A/B EXTI lines are
+     * masked and the pins are polled by rot_enc_tick() instead. 0 (default)
+     * disables storm protection.
+     */
+    uint16_t storm_threshold;
+
+    /*
+     * Optional timer backend. If set, pins A and B are decoded by the timer's
+     * encoder interface mode at zero CPU cost, and no EXTI interrupts are
+     * needed for them. Configure the timer in encoder mode TI1 and TI2 with
+     * ARR at its maximum (0xFFFF, or 0xFFFFFFFF on 32 bit timers), and start
+     * it with HAL_TIM_Encoder_Start() before calling init_rotary_encoder().
+     */
+    TIM_TypeDef *timer;
+
+    /*
+     * Optional index (Z channel) pin, linked to a rising edge EXTI interrupt.
+     * 0 as default, meaning no index. At each index pulse the counter value is
+     * latched and the revolution count updated. If index_auto_zero is true the
+     * counter is also set to 0, homing the encoder. If 0 is outside
+     * counter_min and counter_max it homes to the nearest limit instead,
+     * unless the count mode is unbounded.
+     */
+    uint16_t index_pin;
+    GPIO_TypeDef *index_port;
+    bool index_auto_zero;
+
+    /*
+     * Optional acceleration curve, disabled by default. When enabled, spinning
+     * the encoder quickly increases the step size, see rot_enc_accel_step_t.
+     */
+    bool accel_enabled;
+    const rot_enc_accel_step_t *accel_curve;
+    uint8_t accel_curve_len;
+
+    /*
+     * Scaling applied to each count, step_multiplier / step_divisor, with
+     * any fraction carried over to the next count. E.g. 10 / 1 for 10 units
+     * per count, or 1 / 4 for one unit every 4 counts. Fractions round
+     * towards zero, so a unit takes the same travel in either direction. 0 is
+     * treated as 1, so the default is unscaled.
+     */
+    int16_t step_multiplier;
+    uint16_t step_divisor;
+
+    /*
+     * If true, the counter is restored from the store by init_rotary_encoder()
+     * and saved by rot_enc_save_positions(). Off as default.
+     */
+    bool persist;
+
+    // Optional output mapping, NULL as default, see rot_enc_map_t.
+    const rot_enc_map_t *map;
+
+    /*
+     * Optional change callback, NULL as default. Called by
+     * rot_enc_process_changes() once for any number of counter changes since
+     * the last call.
+     */
+    rot_enc_change_callback_t on_change;
 
     /*
      * These can be ignored when instantiating the struct, as they do not need
@@ -69,9 +488,118 @@ typedef struct
      */
     uint8_t old_state;
     uint8_t new_state;
+
+    // Transitions since the last detent, used by the 2x and 1x resolutions.
+    uint8_t detent_state;
+
+    // Fraction of a unit carried between counts, in 1 / step_divisor units.
+    int32_t step_remainder;
+
+    // Last value written to the store, and the value waiting to be written.
+    rot_enc_count_t persist_value;
+    rot_enc_count_t persist_candidate;
+    uint32_t persist_change_time;
+
+    // Transition statistics, read these with rot_enc_get_stats().
+    rot_enc_stats_t stats;
+
+    // Debounced button state.
+    rot_enc_button_state_t button;
+
+    // Index pulse state, read these with the rot_enc_get_index_* functions.
+    rot_enc_count_t index_position;
+    int32_t revolutions;
+    bool index_seen;
+
+    // Last CNT value read from the timer backend, and the transitions read
+    // since the last whole count.
+    uint32_t timer_last_cnt;
+    int32_t timer_residue;
+
+    // Edge rate measurement, and polling state while EXTI is masked.
+    uint16_t storm_edges;
+    uint32_t storm_window_start;
+    bool storm_active;
+    uint32_t storm_quiet_since;
+
+    /*
+     * Bit positions of pin_a and pin_b within their port's input data
+     * register, calculated at init. When both pins share a port, the state is
+     * sampled with a single IDR read so A and B are captured at the same
+     * instant.
+     */
+    uint8_t shift_a;
+    uint8_t shift_b;
+    bool same_port;
+
+    // Registry index, assigned at init. Used to identify queued events.
+    uint8_t id;
+
+    /*
+     * Edge timing recorded in the ISR. position counts every valid
+     * transition, and is not confined by counter_min and counter_max. For
+     * timer backed handles, it is the timer count extended to 32 bits.
+     */
+    int32_t position;
+    uint32_t last_edge_time;
+    uint32_t edge_period;
+    int8_t last_step;
+    uint32_t last_count_time;
+
+    // Motion estimate, updated lazily by the velocity/acceleration getters.
+    int32_t velocity;
+    int32_t acceleration;
+    int32_t sample_position;
+    uint32_t sample_time;
 }rot_enc_handle_t;
 
 
+/**
+ * Entry in the encoder event queue, recorded each time a counter changes.
+ */
+typedef struct
+{
+    // Timestamp of the change, from ROT_ENC_GET_TIMESTAMP().
+    uint32_t timestamp;
+
+    // Change applied to the counter, before any wrap at its limits.
+    int32_t delta;
+
+    // Registry index of the encoder, see rot_enc_handle_t.
+    uint8_t encoder_id;
+}rot_enc_event_t;
+
+
+/**
+ * Bank of encoders wired to a single GPIO port, decoded together by polling
+ * rather than by EXTI. The whole port is read once per poll and every A/B
+ * pair is decoded in parallel with word-wide logic.
+ * Every B pin must sit b_offset bits above its A pin, e.g. A on pins 0-7 and
+ * B on pins 8-15 (b_offset = 8), or adjacent pairs (b_offset = 1).
+ */
+typedef struct
+{
+    // Port shared by all encoders in the bank.
+    GPIO_TypeDef *port;
+
+    // Array of handles in the bank, and the number of them.
+    rot_enc_handle_t **handles;
+    uint8_t num_of_handles;
+
+    // Distance in bits from each A pin to its B pin.
+    uint8_t b_offset;
+
+    /*
+     * These can be ignored when instantiating the struct, as they are
+     * calculated by init_rotary_encoder_bank().
+     */
+    uint16_t a_mask;
+    uint16_t old_a;
+    uint16_t old_b;
+    rot_enc_handle_t *handle_by_bit[16];
+}rot_enc_bank_t;
+
+
 /**
  * Initialises and registers each encoder. Returns false if failed due to
  * registry array being full (Max No. of encoders exceeded). 
@@ -88,17 +616,243 @@ bool init_rotary_encoder(rot_enc_handle_t *rot_enc_handle_ptr);
  * HAL_GPIO_EXTI_Callback(). 
  * This function will determine which encoder triggered the interrupt,
  * determine whether the input is valid, and increment/decrement the counter.
- * (Or reset it if button pushed).
+ * (Or reset it if button pushed, or latch it on an index pulse).
  * @param takes the GPIO pin number that triggered the interrupt.
  */
 void rot_enc_callback(uint16_t GPIO_Pin);
 
 
 /**
+ * Decodes a new pin state for an encoder read by the caller, e.g. by the
+ * compile-time dispatch in rotary_encoder_static.h, and updates the counter
+ * if the transition is valid.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the new state of pins A and B, in 0b000000AB format.
+ */
+void rot_enc_update_state(rot_enc_handle_t *rot_enc_handle_ptr,
+                          uint8_t new_state);
+
+
+/**
+ * Call this function every millisecond, e.g. from HAL_SYSTICK_Callback() or a
+ * timer period elapsed callback, at the same interrupt priority as the
+ * encoder EXTI interrupts. Samples and debounces buttons which have a
+ * button_port set, and reports their gestures. Also polls encoders whose
+ * interrupts are masked due to an interrupt storm, and reads timer backed
+ * encoders often enough that their count cannot overflow between reads.
+ */
+void rot_enc_tick(void);
+
+
+/**
+ * Takes the oldest debounced button event from the queue. Call this from the
+ * main loop only.
+ * @param takes a pointer to a rot_enc_button_event_t object to copy into.
+ * @return true if an event was copied, false if the queue was empty.
+ */
+bool rot_enc_get_button_event(rot_enc_button_event_t *event_ptr);
+
+
+/**
+ * Reads the counter without tearing, for any ROT_ENC_COUNTER_BITS.
  * @param takes a pointer to a rot_enc_handle_t object.
  * @return the current counter value for the specified encoder.
  */
-int16_t rot_enc_get_count_value(rot_enc_handle_t *rot_enc_handle_ptr);
+rot_enc_count_t rot_enc_get_count_value(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * Captures the counters of several encoders at the same instant, in one short
+ * critical section, so ISRs cannot update some of them part way through.
+ * Timer backed encoders are synced inside the same critical section.
+ * @param takes a pointer to an array of MAX_NUM_OF_ENCODERS counts, indexed
+ * by encoder id. Only the entries selected by the mask are written.
+ * @param takes a bitfield of the encoders to capture, bit n being the encoder
+ * with id n.
+ * @return the timestamp of the snapshot.
+ */
+uint32_t rot_enc_snapshot(rot_enc_count_t *counts, uint32_t mask);
+
+
+/**
+ * Reads the counter and passes it through the handle's map, using integer
+ * interpolation only.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the mapped value, or the counter value if no map is set.
+ */
+int32_t rot_enc_get_mapped_value(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return true once an index pulse has been seen since init.
+ */
+bool rot_enc_get_index_seen(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the counter value latched at the last index pulse, before any
+ * auto-zero.
+ */
+rot_enc_count_t rot_enc_get_index_position(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the number of index pulses seen, incremented or decremented by the
+ * direction of rotation at each one.
+ */
+int32_t rot_enc_get_revolutions(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * Estimates shaft speed, by measuring the period between edges at low speed
+ * and counting transitions per window at high speed.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the velocity in transitions per second, positive when incrementing.
+ */
+int32_t rot_enc_get_velocity(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @return the filtered acceleration in transitions per second per second.
+ */
+int32_t rot_enc_get_acceleration(rot_enc_handle_t *rot_enc_handle_ptr);
+
+
+/**
+ * Initialises a bank of encoders for polled decoding, and registers each of
+ * its handles. Do not enable EXTI interrupts on the bank's A/B pins.
+ * @param takes a pointer to a rot_enc_bank_t object.
+ * @return returns true if every handle is on the bank's port with its B pin
+ * at b_offset from its A pin, and registry was successful, false if not, in
+ * which case none of the handles are registered.
+ */
+bool init_rotary_encoder_bank(rot_enc_bank_t *bank_ptr);
+
+
+/**
+ * Insert this function into your overridden definition of
+ * HAL_TIM_PeriodElapsedCallback() for the timer used to poll the bank. The
+ * polling rate must be faster than the fastest expected edge rate.
+ * @param takes a pointer to a rot_enc_bank_t object.
+ */
+void rot_enc_poll_bank(rot_enc_bank_t *bank_ptr);
+
+
+/**
+ * Decodes a block of GPIO input data register samples, captured by a timer
+ * triggered DMA transfer from the port's IDR into a circular buffer. Call this
+ * from the DMA half transfer and transfer complete callbacks, passing the half
+ * of the buffer that has just been filled. Pins A and B must be on the
+ * sampled port, and must not have EXTI interrupts enabled.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes a pointer to the IDR samples, oldest first.
+ * @param takes the number of samples.
+ */
+void rot_enc_decode_samples(rot_enc_handle_t *rot_enc_handle_ptr,
+                            const uint16_t *samples,
+                            uint32_t num_of_samples);
+
+
+/**
+ * Copies the transition statistics for an encoder, optionally clearing them
+ * in the same critical section so no transitions are lost between the two.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes a pointer to a rot_enc_stats_t object to copy into.
+ * @param takes true to reset the statistics after copying.
+ */
+void rot_enc_get_stats(rot_enc_handle_t *rot_enc_handle_ptr,
+                       rot_enc_stats_t *stats_ptr,
+                       bool reset);
+
+
+/**
+ * Sets the store used to persist counters of handles with persist set. Call
+ * this before init_rotary_encoder(), so counters can be restored.
+ * @param takes a pointer to a rot_enc_store_t object, or NULL to disable
+ * persistence.
+ */
+void rot_enc_set_store(const rot_enc_store_t *store_ptr);
+
+
+/**
+ * Writes persisted counters to the store once they have held still for
+ * ROT_ENC_PERSIST_DELAY_MS. Call this from the main loop, as flash writes
+ * can be slow.
+ */
+void rot_enc_save_positions(void);
+
+
+/**
+ * Bitfield of encoders whose counter has changed since the last call to
+ * rot_enc_process_changes(), bit n being the encoder with id n. Lets the main
+ * loop check every encoder with a single word test.
+ * @return the dirty mask.
+ */
+uint32_t rot_enc_get_dirty_mask(void);
+
+
+/**
+ * Clears the dirty mask, and calls the on_change callback of every encoder
+ * that had changed. Call this from the main loop only.
+ * @return the dirty mask that was processed.
+ */
+uint32_t rot_enc_process_changes(void);
+
+
+/**
+ * Sends the counter, velocity and statistics of every registered encoder as
+ * one binary log frame, see log_binary_frame(), at most once per telemetry
+ * period. Encoders that do not fit in LOG_FRAME_MAX_PAYLOAD spill into
+ * further frames. Call this from the main loop. The payload, all little
+ * endian, is the timestamp (uint32_t) and number of encoders (uint8_t), then
+ * for each encoder its id (uint8_t), counter (int32_t, or int64_t when
+ * ROT_ENC_COUNTER_BITS is 64), velocity (int32_t), and valid_steps,
+ * invalid_transitions, bounces and storms (uint32_t).
+ */
+void rot_enc_publish_telemetry(void);
+
+
+/**
+ * Sets the period between telemetry frames.
+ * @param takes the period in ms, or 0 to stop telemetry.
+ */
+void rot_enc_set_telemetry_period(uint32_t period_ms);
+
+
+#if ROT_ENC_TRACE_DEPTH > 0
+/**
+ * Logs an encoder's trace, oldest entry first, then clears it. Recording for
+ * that encoder is paused during the dump so the trace stays coherent, while
+ * other encoders carry on recording. Each entry is logged in hex, see
+ * ROT_ENC_TRACE_ENTRY() in rotary_encoder_decode.h, and the dump can be
+ * replayed on a PC with tools/rot_enc_trace_replay.cpp.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ */
+void rot_enc_dump_trace(rot_enc_handle_t *rot_enc_handle_ptr);
+#endif
+
+
+#if ROT_ENC_EVENT_QUEUE_SIZE > 0
+/**
+ * Copies queued encoder events, oldest first, and removes them from the
+ * queue. Call this from the main loop only. The queue is single-producer,
+ * so all encoder EXTI and polling interrupts must share one priority.
+ * @param takes a pointer to an array to copy events into.
+ * @param takes the maximum number of events to copy.
+ * @return the number of events copied.
+ */
+uint16_t rot_enc_drain_events(rot_enc_event_t *events, uint16_t max_events);
+
+
+/**
+ * @return the number of events discarded because the queue was full.
+ */
+uint32_t rot_enc_get_dropped_event_count(void);
+#endif
 
 #endif // ROTARY_ENCODER_DOT_H
 
@@ -0,0 +1,157 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rotary_encoder_backup_store.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Position store for the rotary encoder driver, kept in the RTC backup
+ * registers so counters survive a brown-out or reset while VBAT is present.
+ * Backup domain writes must be enabled with HAL_PWR_EnableBkUpAccess() before
+ * use.
+ */
+
+#include "rotary_encoder_backup_store.h"
+#include "stm32f4xx_hal.h"
+
+// Backup registers per slot, one for 16 and 32 bit counters, two for 64 bit.
+#define WORDS_PER_SLOT    ((ROT_ENC_COUNTER_BITS + 31) / 32)
+
+// Slots that fit in the registers, leaving the last one for the marker.
+#define REGISTER_SLOTS    ((ROT_ENC_BACKUP_NUM_REGISTERS - 1) / WORDS_PER_SLOT)
+
+// The marker has a valid bit for each of up to 16 slots, so any registers
+// past the 16th slot are left unused.
+#define MAX_NUM_OF_SLOTS  16
+#define NUM_OF_SLOTS      ((REGISTER_SLOTS < MAX_NUM_OF_SLOTS) ? \
+                           REGISTER_SLOTS : MAX_NUM_OF_SLOTS)
+
+/*
+ * The marker register holds this value in its upper half, and a valid bit
+ * per slot in its lower half. A backup domain reset clears it, so stale or
+ * unwritten slots are never restored.
+ */
+#define MARKER_MAGIC      0xE5C00000UL
+#define MARKER_MAGIC_MASK 0xFFFF0000UL
+
+#if (ROT_ENC_BACKUP_FIRST_REGISTER + ROT_ENC_BACKUP_NUM_REGISTERS) > 20
+#error "The STM32F4 has 20 backup registers, BKP0R to BKP19R"
+#endif
+
+
+// ------------------------------------------------------------------------- //
+// --------------------- Utility function prototypes ----------------------- //
+// ------------------------------------------------------------------------- //
+volatile uint32_t* backup_register(uint8_t index);
+bool backup_store_read(uint8_t slot, rot_enc_count_t *value_ptr);
+void backup_store_write(uint8_t slot, rot_enc_count_t value);
+
+
+// ------------------------------------------------------------------------- //
+// ------------------------- Public variables ------------------------------ //
+// ------------------------------------------------------------------------- //
+
+/*
+ * Store to pass to rot_enc_set_store().
+ */
+const rot_enc_store_t rot_enc_backup_store =
+{
+  .read = backup_store_read,
+  .write = backup_store_write
+};
+
+
+// ------------------------------------------------------------------------- //
+// ------------------------- Private Utility Functions --------------------- //
+// ------------------------------------------------------------------------- //
+
+/**
+ * @param takes the register index, counted from ROT_ENC_BACKUP_FIRST_REGISTER.
+ * @return a pointer to the backup register.
+ */
+volatile uint32_t* backup_register(uint8_t index)
+{
+  // BKP0R to BKP19R are contiguous, so they can be indexed as an array.
+  return &RTC->BKP0R + ROT_ENC_BACKUP_FIRST_REGISTER + index;
+}
+
+
+/**
+ * Reads a slot from the backup registers.
+ * @param takes the slot number, the encoder id.
+ * @param takes a pointer to write the value to.
+ * @return true if the slot holds a value, false if not.
+ */
+bool backup_store_read(uint8_t slot, rot_enc_count_t *value_ptr)
+{
+  uint32_t marker = *backup_register(ROT_ENC_BACKUP_NUM_REGISTERS - 1);
+
+  if (slot >= NUM_OF_SLOTS ||
+      (marker & MARKER_MAGIC_MASK) != MARKER_MAGIC ||
+      (marker & (1UL << slot)) == 0)
+  {
+    return false;
+  }
+
+  uint64_t value = 0;
+  for (uint8_t word = 0; word < WORDS_PER_SLOT; ++word)
+  {
+    value |= (uint64_t)*backup_register(slot * WORDS_PER_SLOT + word) <<
+             (32U * word);
+  }
+  *value_ptr = (rot_enc_count_t)value;
+  return true;
+}
+
+
+/**
+ * Writes a slot to the backup registers, and marks it as valid.
+ * @param takes the slot number, the encoder id.
+ * @param takes the value to write.
+ */
+void backup_store_write(uint8_t slot, rot_enc_count_t value)
+{
+  if (slot >= NUM_OF_SLOTS)
+  {
+    return;
+  }
+
+  uint64_t bits = (uint64_t)(int64_t)value;
+  for (uint8_t word = 0; word < WORDS_PER_SLOT; ++word)
+  {
+    *backup_register(slot * WORDS_PER_SLOT + word) =
+      (uint32_t)(bits >> (32U * word));
+  }
+
+  volatile uint32_t *marker_ptr =
+    backup_register(ROT_ENC_BACKUP_NUM_REGISTERS - 1);
+  uint32_t marker = *marker_ptr;
+  if ((marker & MARKER_MAGIC_MASK) != MARKER_MAGIC)
+  {
+    marker = MARKER_MAGIC;
+  }
+  *marker_ptr = marker | (1UL << slot);
+}
+
+
+// End of file. //
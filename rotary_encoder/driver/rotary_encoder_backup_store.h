@@ -0,0 +1,62 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rotary_encoder_backup_store.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Position store for the rotary encoder driver, kept in the RTC backup
+ * registers so counters survive a brown-out or reset while VBAT is present.
+ * Backup domain writes must be enabled with HAL_PWR_EnableBkUpAccess() before
+ * use.
+ */
+
+#ifndef ROTARY_ENCODER_BACKUP_STORE_DOT_H
+#define ROTARY_ENCODER_BACKUP_STORE_DOT_H
+
+#include "rotary_encoder.h"
+
+/**
+ * First backup register used, and the number of registers available from it.
+ * The last register holds a marker of which slots are valid, and the rest
+ * hold one slot per 32 bits of counter, for up to 16 slots. Encoders with an
+ * id past the last slot are not persisted. Define these in your build flags
+ * to share the registers with other code.
+ */
+#ifndef ROT_ENC_BACKUP_FIRST_REGISTER
+#define ROT_ENC_BACKUP_FIRST_REGISTER   0
+#endif
+
+#ifndef ROT_ENC_BACKUP_NUM_REGISTERS
+#define ROT_ENC_BACKUP_NUM_REGISTERS    20
+#endif
+
+/**
+ * Store to pass to rot_enc_set_store().
+ */
+extern const rot_enc_store_t rot_enc_backup_store;
+
+#endif // ROTARY_ENCODER_BACKUP_STORE_DOT_H
+
+
+// End of file. //
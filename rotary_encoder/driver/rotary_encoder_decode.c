@@ -0,0 +1,288 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rotary_encoder_decode.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Quadrature decode tables and block decoder shared by the encoder
+ * driver and host side tools. Has no HAL dependencies, so it can be compiled
+ * for a PC as well as the target.
+ */
+
+#include "rotary_encoder_decode.h"
+
+/**
+ * State machine table to determine if a transition is valid, and whether it
+ * completes a count at the selected resolution, in a single lookup.
+ * Indexed by [resolution][detent_state][transition], where the 4 bit phase
+ * transition value from the encoder corresponds to decimal index 0-15, and
+ * detent_state is the number of transitions since the last detent as a 3 bit
+ * two's complement value. Each entry packs:
+ * bits 0-2, the next detent_state.
+ * bits 3-4, the transition step -1, 0 or 1 (0 if invalid).
+ * bits 5-6, the count to apply at this resolution -1, 0 or 1.
+ * bit 7, set if both phases changed, meaning a transition was missed.
+ * Returning to a detent with less than half a cycle of travel (e.g. contact
+ * bounce) produces no count, and resynchronises the detent state.
+ */
+const uint8_t rot_enc_state_table[3][8][16] =
+{
+  // 4x, counts every transition.
+  {
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00},
+    {0x00, 0x78, 0x28, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x28, 0x78, 0x00}
+  },
+  // 2x, counts at states 0b00 and 0b11.
+  {
+    {0x00, 0x1F, 0x09, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x09, 0x1F, 0x00},
+    {0x01, 0x18, 0x0A, 0x81, 0x28, 0x01, 0x81, 0x18,
+     0x18, 0x81, 0x01, 0x28, 0x81, 0x0A, 0x18, 0x01},
+    {0x02, 0x19, 0x0B, 0x82, 0x28, 0x02, 0x82, 0x38,
+     0x38, 0x82, 0x02, 0x28, 0x82, 0x0B, 0x19, 0x02},
+    {0x03, 0x1A, 0x0B, 0x83, 0x28, 0x03, 0x83, 0x38,
+     0x38, 0x83, 0x03, 0x28, 0x83, 0x0B, 0x1A, 0x03},
+    {0x00, 0x1F, 0x09, 0x80, 0x28, 0x00, 0x80, 0x78,
+     0x78, 0x80, 0x00, 0x28, 0x80, 0x09, 0x1F, 0x00},
+    {0x05, 0x1D, 0x0E, 0x85, 0x68, 0x05, 0x85, 0x78,
+     0x78, 0x85, 0x05, 0x68, 0x85, 0x0E, 0x1D, 0x05},
+    {0x06, 0x1D, 0x0F, 0x86, 0x68, 0x06, 0x86, 0x78,
+     0x78, 0x86, 0x06, 0x68, 0x86, 0x0F, 0x1D, 0x06},
+    {0x07, 0x1E, 0x08, 0x87, 0x08, 0x07, 0x87, 0x78,
+     0x78, 0x87, 0x07, 0x08, 0x87, 0x08, 0x1E, 0x07}
+  },
+  // 1x, counts at state 0b00.
+  {
+    {0x00, 0x1F, 0x09, 0x80, 0x08, 0x00, 0x80, 0x1F,
+     0x18, 0x80, 0x00, 0x09, 0x80, 0x09, 0x1F, 0x00},
+    {0x01, 0x18, 0x0A, 0x81, 0x28, 0x01, 0x81, 0x18,
+     0x18, 0x81, 0x01, 0x0A, 0x81, 0x0A, 0x18, 0x01},
+    {0x02, 0x19, 0x0B, 0x82, 0x28, 0x02, 0x82, 0x19,
+     0x18, 0x82, 0x02, 0x0B, 0x82, 0x0B, 0x19, 0x02},
+    {0x03, 0x1A, 0x0B, 0x83, 0x28, 0x03, 0x83, 0x1A,
+     0x38, 0x83, 0x03, 0x0B, 0x83, 0x0B, 0x1A, 0x03},
+    {0x00, 0x1F, 0x09, 0x80, 0x08, 0x00, 0x80, 0x1F,
+     0x18, 0x80, 0x00, 0x09, 0x80, 0x09, 0x1F, 0x00},
+    {0x05, 0x1D, 0x0E, 0x85, 0x68, 0x05, 0x85, 0x1D,
+     0x78, 0x85, 0x05, 0x0E, 0x85, 0x0E, 0x1D, 0x05},
+    {0x06, 0x1D, 0x0F, 0x86, 0x08, 0x06, 0x86, 0x1D,
+     0x78, 0x86, 0x06, 0x0F, 0x86, 0x0F, 0x1D, 0x06},
+    {0x07, 0x1E, 0x08, 0x87, 0x08, 0x07, 0x87, 0x1E,
+     0x78, 0x87, 0x07, 0x08, 0x87, 0x08, 0x1E, 0x07}
+  }
+};
+
+
+/**
+ * Next state in each direction of rotation, indexed by [incrementing][state].
+ * Used to fill in the missed intermediate state of a double transition.
+ */
+const uint8_t rot_enc_next_state[2][4] =
+{
+  {1, 3, 0, 2},
+  {2, 0, 3, 1}
+};
+
+
+/*
+ * Decodes a block of port samples at 4x resolution. Each sample is compared
+ * with the one before it, so there are no branches and no loop carried state
+ * other than the totals, allowing the compiler to vectorise the loop.
+ * @param takes a pointer to the samples, oldest first.
+ * @param takes the number of samples.
+ * @param takes the bit position of pin A within each sample.
+ * @param takes the bit position of pin B within each sample.
+ * @param takes the state before the first sample, in 0b000000AB format.
+ * @param takes a pointer to a rot_enc_block_result_t object to write totals to.
+ * @return the state of the last sample, to pass in with the next block.
+ */
+uint8_t rot_enc_decode_block(const uint16_t *samples,
+                             uint32_t num_of_samples,
+                             uint32_t shift_a,
+                             uint32_t shift_b,
+                             uint8_t state,
+                             rot_enc_block_result_t *result_ptr)
+{
+  result_ptr->net_steps = 0;
+  result_ptr->transitions = 0;
+  result_ptr->invalid_transitions = 0;
+
+  if (num_of_samples == 0)
+  {
+    return state;
+  }
+
+  // The first sample is compared with the state left by the last block.
+  // A valid transition changes exactly one phase, and is incrementing if A
+  // changed to differ from B, or B changed to match A.
+  uint32_t a = (samples[0] >> shift_a) & 1U;
+  uint32_t b = (samples[0] >> shift_b) & 1U;
+  uint32_t changed_a = a ^ ((state >> 1) & 1U);
+  uint32_t changed_b = b ^ (state & 1U);
+  uint32_t valid = changed_a ^ changed_b;
+  uint32_t incrementing = valid & (a ^ b ^ changed_b);
+
+  int32_t net_steps = (int32_t)(incrementing << 1) - (int32_t)valid;
+  uint32_t transitions = valid;
+  uint32_t invalid = changed_a & changed_b;
+
+  // The rest are compared with the sample before them.
+  for (uint32_t index = 1; index < num_of_samples; ++index)
+  {
+    uint32_t sample = samples[index];
+    uint32_t previous = samples[index - 1];
+    uint32_t sample_a = (sample >> shift_a) & 1U;
+    uint32_t sample_b = (sample >> shift_b) & 1U;
+    uint32_t sample_changed_a = sample_a ^ ((previous >> shift_a) & 1U);
+    uint32_t sample_changed_b = sample_b ^ ((previous >> shift_b) & 1U);
+    uint32_t sample_valid = sample_changed_a ^ sample_changed_b;
+    uint32_t sample_incrementing = sample_valid &
+                                   (sample_a ^ sample_b ^ sample_changed_b);
+
+    net_steps += (int32_t)(sample_incrementing << 1) - (int32_t)sample_valid;
+    transitions += sample_valid;
+    invalid += sample_changed_a & sample_changed_b;
+  }
+
+  result_ptr->net_steps = net_steps;
+  result_ptr->transitions = transitions;
+  result_ptr->invalid_transitions = invalid;
+
+  uint32_t last = samples[num_of_samples - 1];
+  return (uint8_t)((((last >> shift_a) & 1U) << 1) | ((last >> shift_b) & 1U));
+}
+
+
+/**
+ * Replays one transition, recovering a missed step the way
+ * process_transition() in the driver does.
+ * @param takes the resolution index into rot_enc_state_table.
+ * @param takes true to recover skipped steps.
+ * @param takes the 4 bit transition value, old state << 2 | new state.
+ * @param takes a pointer to the replay state, updated on return.
+ * @param takes a pointer to the totals, updated on return.
+ */
+static void replay_transition(uint32_t resolution,
+                              bool recover_skipped_steps,
+                              uint8_t transition,
+                              rot_enc_replay_state_t *state_ptr,
+                              rot_enc_trace_result_t *result_ptr)
+{
+  uint8_t entry = rot_enc_state_table[resolution][state_ptr->detent_state]
+                                     [transition];
+  state_ptr->detent_state = ROT_ENC_STATE_NEXT(entry);
+
+  int8_t step = ROT_ENC_STATE_STEP(entry);
+  if (step != 0)
+  {
+    result_ptr->net_steps += step;
+    result_ptr->net_counts += ROT_ENC_STATE_COUNT(entry);
+    ++result_ptr->transitions;
+    state_ptr->last_step = step;
+  }
+  else if (ROT_ENC_STATE_DOUBLE(entry))
+  {
+    ++result_ptr->invalid_transitions;
+
+    // Replay as two single steps via the missing state, in the direction of
+    // the last step.
+    if (recover_skipped_steps && state_ptr->last_step != 0)
+    {
+      uint8_t old_state = transition >> 2;
+      uint8_t new_state = transition & 0x03U;
+      uint8_t missed_state =
+        rot_enc_next_state[state_ptr->last_step > 0][old_state];
+
+      replay_transition(resolution, recover_skipped_steps,
+                        (uint8_t)((old_state << 2) | missed_state),
+                        state_ptr, result_ptr);
+      replay_transition(resolution, recover_skipped_steps,
+                        (uint8_t)((missed_state << 2) | new_state),
+                        state_ptr, result_ptr);
+    }
+  }
+  else
+  {
+    ++result_ptr->bounces;
+  }
+}
+
+
+/*
+ * Replays a trace recorder dump through the decode state machine, as the
+ * driver would have seen it, to find where steps were lost.
+ * @param takes a pointer to the trace entries, oldest first.
+ * @param takes the number of entries.
+ * @param takes the resolution index into rot_enc_state_table.
+ * @param takes true if the driver was recovering skipped steps.
+ * @param takes a pointer to the replay state, zeroed before the first entry
+ * and updated on return, so a trace can be replayed in pieces.
+ * @param takes a pointer to a rot_enc_trace_result_t object to write totals
+ * to.
+ */
+void rot_enc_replay_trace(const uint32_t *entries,
+                          uint32_t num_of_entries,
+                          uint32_t resolution,
+                          bool recover_skipped_steps,
+                          rot_enc_replay_state_t *state_ptr,
+                          rot_enc_trace_result_t *result_ptr)
+{
+  rot_enc_trace_result_t result = {0, 0, 0, 0, 0, 0, 0};
+
+  for (uint32_t index = 0; index < num_of_entries; ++index)
+  {
+    uint8_t transition = ROT_ENC_TRACE_TRANSITION(entries[index]);
+    result.duration += ROT_ENC_TRACE_DELTA(entries[index]);
+
+    // Each ISR run starts from the state the previous one ended in.
+    if (index > 0 &&
+        (transition >> 2) != (ROT_ENC_TRACE_TRANSITION(entries[index - 1]) &
+                              0x03U))
+    {
+      ++result.gaps;
+    }
+
+    replay_transition(resolution, recover_skipped_steps, transition,
+                      state_ptr, &result);
+  }
+
+  *result_ptr = result;
+}
+
+
+// End of file. //
@@ -0,0 +1,188 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rotary_encoder_decode.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Quadrature decode tables and block decoder shared by the encoder
+ * driver and host side tools. Has no HAL dependencies, so it can be compiled
+ * for a PC as well as the target.
+ */
+
+#ifndef ROTARY_ENCODER_DECODE_DOT_H
+#define ROTARY_ENCODER_DECODE_DOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fields packed into each rot_enc_state_table entry.
+ * NEXT is the next detent_state.
+ * STEP is the transition step -1, 0 or 1 (0 if invalid).
+ * COUNT is the count to apply at the table's resolution -1, 0 or 1.
+ * DOUBLE is non-zero if both phases changed, meaning a transition was missed.
+ */
+#define ROT_ENC_STATE_NEXT(entry)     ((uint8_t)((entry) & 0x07U))
+#define ROT_ENC_STATE_STEP(entry)     ((int8_t)(uint8_t)((entry) << 3) >> 6)
+#define ROT_ENC_STATE_COUNT(entry)    ((int8_t)(uint8_t)((entry) << 1) >> 6)
+#define ROT_ENC_STATE_DOUBLE(entry)   ((entry) & 0x80U)
+
+
+/**
+ * Fields packed into each trace recorder entry. TRANSITION is the 4 bit
+ * transition, old state << 2 | new state. DELTA is the time since the
+ * previous entry in timestamp ticks, saturated at ROT_ENC_TRACE_DELTA_MAX.
+ */
+#define ROT_ENC_TRACE_DELTA_MAX             0x0FFFFFFFUL
+#define ROT_ENC_TRACE_ENTRY(transition, delta) \
+  (((uint32_t)(transition) << 28) | ((uint32_t)(delta) & ROT_ENC_TRACE_DELTA_MAX))
+#define ROT_ENC_TRACE_TRANSITION(entry)     ((uint8_t)((entry) >> 28))
+#define ROT_ENC_TRACE_DELTA(entry)          ((entry) & ROT_ENC_TRACE_DELTA_MAX)
+
+
+/**
+ * Totals from decoding a block of samples with rot_enc_decode_block().
+ */
+typedef struct
+{
+    // Net transitions, positive when incrementing.
+    int32_t net_steps;
+
+    // Transitions where exactly one phase changed.
+    uint32_t transitions;
+
+    // Transitions where both phases changed, so a step was missed.
+    uint32_t invalid_transitions;
+}rot_enc_block_result_t;
+
+
+/**
+ * Totals from replaying a trace with rot_enc_replay_trace().
+ */
+typedef struct
+{
+    // Net transitions, positive when incrementing, and net counts at the
+    // replayed resolution.
+    int32_t net_steps;
+    int32_t net_counts;
+
+    // Transitions where exactly one phase changed.
+    uint32_t transitions;
+
+    // Transitions where both phases changed, so a step was missed.
+    uint32_t invalid_transitions;
+
+    // Interrupts where the pins were back where they were.
+    uint32_t bounces;
+
+    // Entries whose old state is not the previous entry's new state, meaning
+    // entries are missing from the trace, e.g. dropped during a dump.
+    uint32_t gaps;
+
+    // Sum of the entry deltas, in timestamp ticks.
+    uint64_t duration;
+}rot_enc_trace_result_t;
+
+
+/**
+ * Decoder state carried between calls to rot_enc_replay_trace(). Zero it
+ * before the first entry.
+ */
+typedef struct
+{
+    // Transitions since the last detent, see rot_enc_state_table.
+    uint8_t detent_state;
+
+    // Direction of the last valid step, -1 or 1, 0 if there has been none.
+    int8_t last_step;
+}rot_enc_replay_state_t;
+
+
+/**
+ * State machine table, indexed by [resolution][detent_state][transition].
+ * Resolution is 0 for 4x, 1 for 2x and 2 for 1x, matching
+ * rot_enc_resolution_t. Transition is old state << 2 | new state, where each
+ * state is 0b000000AB.
+ */
+extern const uint8_t rot_enc_state_table[3][8][16];
+
+
+/**
+ * Next state in each direction of rotation, indexed by [incrementing][state].
+ */
+extern const uint8_t rot_enc_next_state[2][4];
+
+
+/**
+ * Decodes a block of port samples at 4x resolution. Each sample is compared
+ * with the one before it, so there are no branches and no loop carried state
+ * other than the totals, allowing the compiler to vectorise the loop.
+ * @param takes a pointer to the samples, oldest first.
+ * @param takes the number of samples.
+ * @param takes the bit position of pin A within each sample.
+ * @param takes the bit position of pin B within each sample.
+ * @param takes the state before the first sample, in 0b000000AB format.
+ * @param takes a pointer to a rot_enc_block_result_t object to write totals to.
+ * @return the state of the last sample, to pass in with the next block.
+ */
+uint8_t rot_enc_decode_block(const uint16_t *samples,
+                             uint32_t num_of_samples,
+                             uint32_t shift_a,
+                             uint32_t shift_b,
+                             uint8_t state,
+                             rot_enc_block_result_t *result_ptr);
+
+
+
+/**
+ * Replays a trace recorder dump through the decode state machine, as the
+ * driver would have seen it, to find where steps were lost.
+ * @param takes a pointer to the trace entries, oldest first.
+ * @param takes the number of entries.
+ * @param takes the resolution index into rot_enc_state_table.
+ * @param takes true if the driver was recovering skipped steps.
+ * @param takes a pointer to the replay state, zeroed before the first entry
+ * and updated on return, so a trace can be replayed in pieces.
+ * @param takes a pointer to a rot_enc_trace_result_t object to write totals
+ * to.
+ */
+void rot_enc_replay_trace(const uint32_t *entries,
+                          uint32_t num_of_entries,
+                          uint32_t resolution,
+                          bool recover_skipped_steps,
+                          rot_enc_replay_state_t *state_ptr,
+                          rot_enc_trace_result_t *result_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROTARY_ENCODER_DECODE_DOT_H
+
+
+// End of file. //
@@ -0,0 +1,88 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rotary_encoder_port.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Inline GPIO port access for the encoder driver. Single pins are read
+ * with HAL_GPIO_ReadPin() by default, or straight from the input data
+ * register with ROT_ENC_DIRECT_REGISTER_ACCESS, avoiding its call, parameter
+ * assertions and branch on every edge.
+ */
+
+#ifndef ROTARY_ENCODER_PORT_DOT_H
+#define ROTARY_ENCODER_PORT_DOT_H
+
+#include <stdint.h>
+#include "gpio.h"
+
+/**
+ * Set to 1 to read pins straight from the IDR with their pin masks, or 0
+ * (default) to read single pins through HAL_GPIO_ReadPin(). Define this in
+ * your build flags to use the direct reads. Same port pairs and banks always
+ * read the whole IDR at once.
+ */
+#ifndef ROT_ENC_DIRECT_REGISTER_ACCESS
+#define ROT_ENC_DIRECT_REGISTER_ACCESS  0
+#endif
+
+/**
+ * Reads a port's input data register. A host build can define this to read
+ * from a simulated port instead.
+ */
+#ifndef ROT_ENC_PORT_READ
+#define ROT_ENC_PORT_READ(port)         ((port)->IDR)
+#endif
+
+
+/**
+ * @param takes a pointer to a GPIO port.
+ * @return the level of every pin on the port, pin n in bit n.
+ */
+static inline uint32_t rot_enc_port_read(GPIO_TypeDef *port)
+{
+  return ROT_ENC_PORT_READ(port);
+}
+
+
+/**
+ * @param takes a pointer to a GPIO port.
+ * @param takes a GPIO pin mask (GPIO_PIN_0 to GPIO_PIN_15).
+ * @return the level of the pin, GPIO_PIN_SET or GPIO_PIN_RESET.
+ */
+static inline GPIO_PinState rot_enc_port_read_pin(GPIO_TypeDef *port,
+                                                  uint16_t pin)
+{
+#if ROT_ENC_DIRECT_REGISTER_ACCESS
+  return ((rot_enc_port_read(port) & pin) != 0U) ? GPIO_PIN_SET :
+                                                   GPIO_PIN_RESET;
+#else
+  return HAL_GPIO_ReadPin(port, pin);
+#endif
+}
+
+#endif // ROTARY_ENCODER_PORT_DOT_H
+
+
+// End of file. //
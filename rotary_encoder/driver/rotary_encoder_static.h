@@ -0,0 +1,158 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rotary_encoder_static.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Compile-time encoder configuration, for boards with a fixed pinout.
+ * Generates a handle per encoder, and an EXTI dispatch switch with the port
+ * reads, masks and shifts resolved at compile time, so the interrupt avoids
+ * the registry search and runtime pin lookups of rot_enc_callback().
+ *
+ * List the encoders with an X-macro, then include this header in the one
+ * source file that defines HAL_GPIO_EXTI_Callback():
+ *
+ *   #define ROT_ENC_STATIC_ENCODERS(X) \
+ *     X(volume, GPIOA, 0, GPIOA, 1)    \
+ *     X(tuning, GPIOB, 4, GPIOC, 5)
+ *   #include "rotary_encoder_static.h"
+ *
+ *   void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+ *   {
+ *     rot_enc_static_callback(GPIO_Pin);
+ *   }
+ *
+ * Each entry takes a name, then the port and pin number (0 to 15) of pins A
+ * and B. This generates a handle named rot_enc_<name>, e.g. rot_enc_volume.
+ * Set any other handle fields, such as counter_max, before calling
+ * rot_enc_static_init(). Each pin number can only be used once, as it is
+ * also the EXTI line; reusing one is a duplicate case compile error.
+ * Any other EXTI line, such as a button_pin or index_pin set on a generated
+ * handle, falls through to rot_enc_callback(), so those keep working at the
+ * cost of its registry search. Storm protection needs rot_enc_callback(), as
+ * the generated dispatch does not count edges.
+ */
+
+#ifndef ROTARY_ENCODER_STATIC_DOT_H
+#define ROTARY_ENCODER_STATIC_DOT_H
+
+#include "rotary_encoder.h"
+#include "rotary_encoder_port.h"
+
+#ifndef ROT_ENC_STATIC_ENCODERS
+#error "Define ROT_ENC_STATIC_ENCODERS(X) before including rotary_encoder_static.h"
+#endif
+
+
+// ------------------------------------------------------------------------- //
+// ------------------------- Generated handles ----------------------------- //
+// ------------------------------------------------------------------------- //
+
+#define ROT_ENC_STATIC_HANDLE(name, pa, a, pb, b)                            \
+  static rot_enc_handle_t rot_enc_##name =                                   \
+  {                                                                          \
+    .pin_a = (uint16_t)(1U << (a)),                                          \
+    .pin_b = (uint16_t)(1U << (b)),                                          \
+    .port_a = (pa),                                                          \
+    .port_b = (pb)                                                           \
+  };
+
+ROT_ENC_STATIC_ENCODERS(ROT_ENC_STATIC_HANDLE)
+
+// Fails to compile, with a negative array size, if there are too many.
+#define ROT_ENC_STATIC_ONE(name, pa, a, pb, b) + 1
+typedef char rot_enc_static_count_check
+  [(0 ROT_ENC_STATIC_ENCODERS(ROT_ENC_STATIC_ONE)) <= MAX_NUM_OF_ENCODERS ?
+   1 : -1];
+
+
+// ------------------------------------------------------------------------- //
+// ------------------------- Generated functions --------------------------- //
+// ------------------------------------------------------------------------- //
+
+/**
+ * Reads pins A and B. With constant arguments this inlines to one IDR read
+ * when both pins share a port, and two otherwise, with fixed shifts.
+ * @param takes the port and pin number of pin A.
+ * @param takes the port and pin number of pin B.
+ * @return digital state of pins A and B, in 0b000000AB format.
+ */
+static inline uint8_t rot_enc_static_state(GPIO_TypeDef *port_a,
+                                           uint32_t a,
+                                           GPIO_TypeDef *port_b,
+                                           uint32_t b)
+{
+  uint32_t idr_a = rot_enc_port_read(port_a);
+  uint32_t idr_b = (port_a == port_b) ? idr_a : rot_enc_port_read(port_b);
+
+  return (uint8_t)((((idr_a >> a) & 1U) << 1) | ((idr_b >> b) & 1U));
+}
+
+
+/**
+ * Registers every generated handle, in the order listed, so that
+ * rot_enc_tick() and the rest of the API work with them.
+ * @return true if every encoder was registered, false if not.
+ */
+#define ROT_ENC_STATIC_INIT(name, pa, a, pb, b)                              \
+  success &= init_rotary_encoder(&rot_enc_##name);
+
+static inline bool rot_enc_static_init(void)
+{
+  bool success = true;
+  ROT_ENC_STATIC_ENCODERS(ROT_ENC_STATIC_INIT)
+  return success;
+}
+
+
+/**
+ * Call this from HAL_GPIO_EXTI_Callback() in place of rot_enc_callback().
+ * Dispatches straight to the encoder on that pin with a switch, then decodes
+ * its new state. Lines that are not an A or B pin go to rot_enc_callback().
+ * @param takes the GPIO pin number that triggered the interrupt.
+ */
+#define ROT_ENC_STATIC_CASE(name, pa, a, pb, b)                              \
+  case (1U << (a)):                                                          \
+  case (1U << (b)):                                                          \
+    rot_enc_update_state(&rot_enc_##name,                                    \
+                         rot_enc_static_state((pa), (a), (pb), (b)));        \
+    break;
+
+static inline void rot_enc_static_callback(uint16_t GPIO_Pin)
+{
+  switch (GPIO_Pin)
+  {
+    ROT_ENC_STATIC_ENCODERS(ROT_ENC_STATIC_CASE)
+
+    // Button and index pins, or lines of encoders registered at runtime.
+    default:
+      rot_enc_callback(GPIO_Pin);
+      break;
+  }
+}
+
+#endif // ROTARY_ENCODER_STATIC_DOT_H
+
+
+// End of file. //
@@ -0,0 +1,216 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file bench_bank.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Compares the cost per poll of bit-parallel bank decoding with
+ * polling each encoder through the lookup table, for 1, 4, 8 and 16
+ * encoders. Banks hold up to 8 encoders, A on pins 0-7 and B on pins 8-15,
+ * so 16 encoders use two ports.
+ */
+
+#define MAX_NUM_OF_ENCODERS   16
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_POLLS          200000
+#define ENCODERS_PER_PORT     8
+
+static GPIO_TypeDef ports[2];
+static rot_enc_handle_t encoders[16];
+static rot_enc_handle_t *handles[16];
+static rot_enc_bank_t banks[2];
+static uint16_t samples[2][NUM_OF_POLLS];
+
+
+/**
+ * Fills in the port samples, each encoder moving on about a quarter of the
+ * polls.
+ */
+static void make_samples(void)
+{
+  int32_t positions[16] = {0};
+
+  for (int poll = 0; poll < NUM_OF_POLLS; ++poll)
+  {
+    samples[0][poll] = 0;
+    samples[1][poll] = 0;
+    for (int index = 0; index < 16; ++index)
+    {
+      uint32_t move = test_random() % 8U;
+      positions[index] += (move == 0) ? 1 : (move == 1) ? -1 : 0;
+
+      uint8_t state = test_quadrature_state(positions[index]);
+      int bit = index % ENCODERS_PER_PORT;
+      samples[index / ENCODERS_PER_PORT][poll] |=
+        (uint16_t)((((state >> 1) & 1U) << bit) | ((state & 1U) << (bit + 8)));
+    }
+  }
+}
+
+
+/**
+ * Registers a number of encoders, as banks or individually.
+ * @param takes the number of encoders.
+ * @param takes true to set up banks.
+ * @return the number of ports used.
+ */
+static int setup(int num_of_encoders, bool use_banks)
+{
+  test_reset_driver();
+  ports[0].IDR = 0;
+  ports[1].IDR = 0;
+
+  for (int index = 0; index < num_of_encoders; ++index)
+  {
+    int bit = index % ENCODERS_PER_PORT;
+    rot_enc_handle_t encoder =
+    {
+      .pin_a = (uint16_t)(1U << bit),
+      .pin_b = (uint16_t)(1U << (bit + 8)),
+      .port_a = &ports[index / ENCODERS_PER_PORT],
+      .port_b = &ports[index / ENCODERS_PER_PORT],
+      .count_mode = ROT_ENC_UNBOUNDED
+    };
+    encoders[index] = encoder;
+    handles[index] = &encoders[index];
+  }
+
+  int num_of_ports = (num_of_encoders + ENCODERS_PER_PORT - 1) /
+                     ENCODERS_PER_PORT;
+  for (int port = 0; port < num_of_ports; ++port)
+  {
+    int first = port * ENCODERS_PER_PORT;
+    int count = num_of_encoders - first;
+    count = (count > ENCODERS_PER_PORT) ? ENCODERS_PER_PORT : count;
+
+    rot_enc_bank_t bank =
+    {
+      .port = &ports[port],
+      .handles = &handles[first],
+      .num_of_handles = (uint8_t)count,
+      .b_offset = 8
+    };
+    banks[port] = bank;
+
+    if (use_banks)
+    {
+      init_rotary_encoder_bank(&banks[port]);
+    }
+    else
+    {
+      for (int index = first; index < first + count; ++index)
+      {
+        init_rotary_encoder(&encoders[index]);
+      }
+    }
+  }
+  return num_of_ports;
+}
+
+
+/**
+ * @return ns per poll of every encoder, decoded with the banks.
+ */
+static double run_banks(int num_of_encoders)
+{
+  int num_of_ports = setup(num_of_encoders, true);
+  double start = test_time_ns();
+
+  for (int poll = 0; poll < NUM_OF_POLLS; ++poll)
+  {
+    for (int port = 0; port < num_of_ports; ++port)
+    {
+      ports[port].IDR = samples[port][poll];
+      rot_enc_poll_bank(&banks[port]);
+    }
+  }
+  return (test_time_ns() - start) / NUM_OF_POLLS;
+}
+
+
+/**
+ * @return ns per poll of every encoder, decoded one at a time with the
+ * lookup table.
+ */
+static double run_table(int num_of_encoders)
+{
+  int num_of_ports = setup(num_of_encoders, false);
+  double start = test_time_ns();
+
+  for (int poll = 0; poll < NUM_OF_POLLS; ++poll)
+  {
+    for (int port = 0; port < num_of_ports; ++port)
+    {
+      ports[port].IDR = samples[port][poll];
+    }
+    for (int index = 0; index < num_of_encoders; ++index)
+    {
+      uint8_t state = get_state(&encoders[index]);
+      if (state != encoders[index].old_state)
+      {
+        rot_enc_update_state(&encoders[index], state);
+      }
+    }
+  }
+  return (test_time_ns() - start) / NUM_OF_POLLS;
+}
+
+
+int main(void)
+{
+  static const int sizes[] = {1, 4, 8, 16};
+
+  make_samples();
+
+  printf("bench_bank: ns per poll of all encoders\n");
+  printf("encoders   table   bank   speedup\n");
+  for (size_t index = 0; index < sizeof(sizes) / sizeof(sizes[0]); ++index)
+  {
+    double table_ns = run_table(sizes[index]);
+    double bank_ns = run_banks(sizes[index]);
+
+    // Both must decode the same counts.
+    rot_enc_count_t table_counts[16];
+    run_table(sizes[index]);
+    for (int encoder = 0; encoder < sizes[index]; ++encoder)
+    {
+      table_counts[encoder] = encoders[encoder].counter;
+    }
+    run_banks(sizes[index]);
+    for (int encoder = 0; encoder < sizes[index]; ++encoder)
+    {
+      CHECK_EQ(encoders[encoder].counter, table_counts[encoder]);
+    }
+
+    printf("%8d %7.1f %6.1f %8.2fx\n", sizes[index], table_ns, bank_ns,
+           table_ns / bank_ns);
+  }
+  return test_report("bench_bank");
+}
+
+
+// End of file. //
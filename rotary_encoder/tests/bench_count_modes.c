@@ -0,0 +1,129 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file bench_count_modes.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Compares the cost of a counter update in each count mode with the
+ * original saturation code, which checked the limits with an if/else chain
+ * before adding the step. Steps are random, so the counter keeps hitting
+ * its limits and branches cannot be predicted.
+ */
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_STEPS    1000000
+
+static int8_t steps[NUM_OF_STEPS];
+
+
+/**
+ * The original saturation code, from decode_phase_transition() before count
+ * modes were added.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the step, -1 or 1.
+ */
+static void __attribute__((noinline)) original_update(
+  rot_enc_handle_t *handle_ptr, int8_t lookup_value)
+{
+  // Test if we are decrementing.
+  if (lookup_value < 0)
+  {
+    // Check lower limit.
+    if (handle_ptr->counter > handle_ptr->counter_min)
+    {
+      handle_ptr->counter += lookup_value;
+    }
+  }
+  // Test if we are incrementing.
+  else if (lookup_value > 0)
+  {
+    // Check upper limit.
+    if (handle_ptr->counter < handle_ptr->counter_max)
+    {
+      handle_ptr->counter += lookup_value;
+    }
+  }
+}
+
+
+/**
+ * @return a handle with a small range, so the limits are hit often.
+ */
+static rot_enc_handle_t make_handle(rot_enc_count_mode_t count_mode)
+{
+  rot_enc_handle_t handle =
+  {
+    .counter_min = 0,
+    .counter_max = 3,
+    .count_mode = count_mode
+  };
+  return handle;
+}
+
+
+int main(void)
+{
+  static const char *const names[] = {"saturate", "wrap", "unbounded"};
+
+  for (uint32_t index = 0; index < NUM_OF_STEPS; ++index)
+  {
+    steps[index] = (test_random() & 1U) ? 1 : -1;
+  }
+
+  printf("bench_count_modes: ns per counter update\n");
+
+  rot_enc_handle_t original = make_handle(ROT_ENC_SATURATE);
+  double start = test_time_ns();
+  for (uint32_t index = 0; index < NUM_OF_STEPS; ++index)
+  {
+    original_update(&original, steps[index]);
+  }
+  double original_ns = (test_time_ns() - start) / NUM_OF_STEPS;
+  printf("original saturate  %5.2f\n", original_ns);
+
+  for (int mode = ROT_ENC_SATURATE; mode <= ROT_ENC_UNBOUNDED; ++mode)
+  {
+    test_reset_driver();
+    rot_enc_handle_t handle = make_handle((rot_enc_count_mode_t)mode);
+    start = test_time_ns();
+    for (uint32_t index = 0; index < NUM_OF_STEPS; ++index)
+    {
+      update_counter(&handle, steps[index], 0);
+    }
+    printf("%-18s %5.2f\n", names[mode],
+           (test_time_ns() - start) / NUM_OF_STEPS);
+
+    if (mode == ROT_ENC_SATURATE)
+    {
+      CHECK_EQ(handle.counter, original.counter);
+    }
+  }
+
+  return test_report("bench_count_modes");
+}
+
+
+// End of file. //
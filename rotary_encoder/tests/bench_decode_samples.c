@@ -0,0 +1,130 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file bench_decode_samples.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Measures how many DMA captured IDR samples per second
+ * rot_enc_decode_samples() can decode, passed in half buffers of 512 as from
+ * the DMA half and full transfer callbacks. Covers the 4x block decoder, and
+ * the table path used for 1x and skipped-step recovery.
+ */
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_SAMPLES    (1U << 22)
+#define HALF_BUFFER       512U
+#define NUM_OF_RUNS       5
+
+static uint16_t samples[NUM_OF_SAMPLES];
+static int32_t final_position;
+
+
+/**
+ * Fills in samples of an encoder on pins 3 and 4, among other changing pins,
+ * moving one transition every 4 to 12 samples and reversing now and then.
+ */
+static void make_samples(void)
+{
+  int32_t position = 0;
+  int8_t step = 1;
+  uint32_t next_edge = 8;
+
+  for (uint32_t index = 0; index < NUM_OF_SAMPLES; ++index)
+  {
+    if (index == next_edge)
+    {
+      if (test_random() % 64U == 0)
+      {
+        step = -step;
+      }
+      position += step;
+      next_edge += 4U + test_random() % 9U;
+    }
+    uint8_t state = test_quadrature_state(position);
+    samples[index] = (uint16_t)((test_random() & 0xE7U) |
+                                (((state >> 1) & 1U) << 3) |
+                                ((state & 1U) << 4));
+  }
+  final_position = position;
+}
+
+
+/**
+ * Decodes every sample with the given settings.
+ * @param takes the resolution.
+ * @param takes true to enable skipped-step recovery.
+ * @param takes the name to print.
+ */
+static void run(rot_enc_resolution_t resolution, bool recover, const char *name)
+{
+  GPIO_TypeDef port = {0};
+  double best_ns = 0.0;
+
+  for (int run = 0; run < NUM_OF_RUNS; ++run)
+  {
+    test_reset_driver();
+    rot_enc_handle_t encoder =
+    {
+      .pin_a = GPIO_PIN_3,
+      .pin_b = GPIO_PIN_4,
+      .port_a = &port,
+      .port_b = &port,
+      .count_mode = ROT_ENC_UNBOUNDED,
+      .resolution = resolution,
+      .recover_skipped_steps = recover
+    };
+    init_rotary_encoder(&encoder);
+
+    double start = test_time_ns();
+    for (uint32_t offset = 0; offset < NUM_OF_SAMPLES; offset += HALF_BUFFER)
+    {
+      rot_enc_decode_samples(&encoder, &samples[offset], HALF_BUFFER);
+    }
+    double elapsed_ns = test_time_ns() - start;
+    best_ns = (run == 0 || elapsed_ns < best_ns) ? elapsed_ns : best_ns;
+
+    CHECK_EQ(encoder.position, final_position);
+  }
+
+  printf("%-22s %7.1f Msamples/s\n", name,
+         (double)NUM_OF_SAMPLES / best_ns * 1e3);
+}
+
+
+int main(void)
+{
+  make_samples();
+
+  printf("bench_decode_samples: %u samples in blocks of %u\n",
+         NUM_OF_SAMPLES, HALF_BUFFER);
+  run(ROT_ENC_RESOLUTION_4X, false, "4x block decoder");
+  run(ROT_ENC_RESOLUTION_4X, true, "4x with recovery");
+  run(ROT_ENC_RESOLUTION_1X, false, "1x table");
+  return test_report("bench_decode_samples");
+}
+
+
+// End of file. //
@@ -0,0 +1,95 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file bench_port_read.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Measures the ISR cost for an encoder with pins A and B on different
+ * ports, the case that reads single pins. Built once with
+ * ROT_ENC_DIRECT_REGISTER_ACCESS 0, reading through HAL_GPIO_ReadPin(), and
+ * once with 1, masking the IDR directly.
+ */
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_EDGES  1000000
+
+static GPIO_TypeDef port_a;
+static GPIO_TypeDef port_b;
+static uint8_t edge_state[NUM_OF_EDGES];
+static uint16_t edge_pin[NUM_OF_EDGES];
+
+
+int main(void)
+{
+  test_reset_driver();
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_3,
+    .pin_b = GPIO_PIN_7,
+    .port_a = &port_a,
+    .port_b = &port_b,
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  CHECK(init_rotary_encoder(&encoder));
+
+  int32_t position = 0;
+  for (uint32_t edge = 0; edge < NUM_OF_EDGES; ++edge)
+  {
+    int32_t step = ((test_random() % 4U) == 0) ? -1 : 1;
+    uint8_t old_state = test_quadrature_state(position);
+    position += step;
+    edge_state[edge] = test_quadrature_state(position);
+    edge_pin[edge] = ((old_state ^ edge_state[edge]) & 0x2U) ?
+                     encoder.pin_a : encoder.pin_b;
+  }
+
+  double start = test_time_ns();
+  for (uint32_t edge = 0; edge < NUM_OF_EDGES; ++edge)
+  {
+    test_set_pins(&encoder, edge_state[edge]);
+    rot_enc_callback(edge_pin[edge]);
+  }
+  double isr_ns = (test_time_ns() - start) / NUM_OF_EDGES;
+  CHECK_EQ(encoder.counter, (rot_enc_count_t)position);
+
+  volatile uint8_t sink = 0;
+  start = test_time_ns();
+  for (uint32_t edge = 0; edge < NUM_OF_EDGES; ++edge)
+  {
+    sink = get_state(&encoder);
+  }
+  double read_ns = (test_time_ns() - start) / NUM_OF_EDGES;
+  (void)sink;
+
+  printf("bench_port_read: %s, ns per ISR %5.2f, ns per get_state() %5.2f\n",
+         ROT_ENC_DIRECT_REGISTER_ACCESS ? "direct IDR reads" :
+                                          "HAL_GPIO_ReadPin()",
+         isr_ns, read_ns);
+  return test_report("bench_port_read");
+}
+
+
+// End of file. //
@@ -0,0 +1,182 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file bench_process_changes.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Measures the main loop cost of watching 16 encoders for changes,
+ * polling every counter against its last value compared with checking the
+ * dirty mask and running rot_enc_process_changes(). Each pass first turns a
+ * number of encoders one transition through rot_enc_update_state(), the same
+ * way for both methods, so the difference between them is the main loop's
+ * share. 16 encoders need more than the 16 EXTI lines, so rather than
+ * rot_enc_callback() the pin state is passed in as the static dispatch in
+ * rotary_encoder_static.h would.
+ */
+
+#define MAX_NUM_OF_ENCODERS   16
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_PASSES         1000000
+
+static GPIO_TypeDef ports[2];
+static rot_enc_handle_t encoders[MAX_NUM_OF_ENCODERS];
+static int32_t positions[MAX_NUM_OF_ENCODERS];
+static uint32_t changes_seen = 0;
+
+
+/**
+ * on_change callback, counting the changes handled.
+ * @param takes a pointer to the changed rot_enc_handle_t object.
+ */
+static void on_change(rot_enc_handle_t *handle_ptr)
+{
+  (void)handle_ptr;
+  ++changes_seen;
+}
+
+
+/**
+ * Runs the ISR's decode for the first encoders, turning each one transition,
+ * so the counter update and the dirty mask store are both included.
+ * @param takes the number of encoders to change.
+ */
+static inline void change_encoders(uint32_t num_of_changed)
+{
+  for (uint32_t index = 0; index < num_of_changed; ++index)
+  {
+    ++positions[index];
+    rot_enc_update_state(&encoders[index],
+                         test_quadrature_state(positions[index]));
+  }
+
+  // Keep the compiler from merging passes, as it could not with a real ISR.
+  __asm__ volatile("" ::: "memory");
+}
+
+
+/**
+ * The main loop without the dirty mask, reading every counter.
+ * @param takes the number of encoders changed per pass.
+ * @return ns per pass.
+ */
+static double __attribute__((noinline)) run_polling(uint32_t num_of_changed)
+{
+  rot_enc_count_t last_count[MAX_NUM_OF_ENCODERS] = {0};
+
+  double start = test_time_ns();
+  for (uint32_t pass = 0; pass < NUM_OF_PASSES; ++pass)
+  {
+    change_encoders(num_of_changed);
+    for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+    {
+      rot_enc_count_t count = rot_enc_get_count_value(&encoders[index]);
+      if (count != last_count[index])
+      {
+        last_count[index] = count;
+        on_change(&encoders[index]);
+      }
+    }
+  }
+  return (test_time_ns() - start) / NUM_OF_PASSES;
+}
+
+
+/**
+ * The main loop with the dirty mask, only processing when it is set.
+ * @param takes the number of encoders changed per pass.
+ * @param takes a pointer to a count of passes where the mask did not match
+ * the encoders turned, updated on return.
+ * @return ns per pass.
+ */
+static double __attribute__((noinline)) run_dirty_mask(uint32_t num_of_changed,
+                                                       uint32_t *mismatches_ptr)
+{
+  // Encoder ids match their index, as they were registered in order.
+  uint32_t expected = (1UL << num_of_changed) - 1U;
+  uint32_t mismatches = 0;
+
+  double start = test_time_ns();
+  for (uint32_t pass = 0; pass < NUM_OF_PASSES; ++pass)
+  {
+    change_encoders(num_of_changed);
+    uint32_t mask = rot_enc_get_dirty_mask();
+    mismatches += (mask != expected);
+    if (mask != 0)
+    {
+      rot_enc_process_changes();
+    }
+  }
+  *mismatches_ptr = mismatches;
+  return (test_time_ns() - start) / NUM_OF_PASSES;
+}
+
+
+int main(void)
+{
+  static const uint32_t changed_counts[] = {0, 1, 4, 16};
+
+  test_reset_driver();
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    // 8 encoders per port, each on its own pair of pins.
+    encoders[index].pin_a = (uint16_t)(GPIO_PIN_0 << (2U * (index % 8U)));
+    encoders[index].pin_b = (uint16_t)(GPIO_PIN_1 << (2U * (index % 8U)));
+    encoders[index].port_a = &ports[index / 8U];
+    encoders[index].port_b = &ports[index / 8U];
+    encoders[index].count_mode = ROT_ENC_UNBOUNDED;
+    encoders[index].on_change = on_change;
+    CHECK(init_rotary_encoder(&encoders[index]));
+    CHECK_EQ(encoders[index].id, index);
+  }
+
+  printf("bench_process_changes: ns per main loop pass, 16 encoders, "
+         "including the ISR decode\n");
+  printf("changed  polling  dirty mask\n");
+
+  for (uint32_t index = 0; index < 4; ++index)
+  {
+    uint32_t num_of_changed = changed_counts[index];
+    changes_seen = 0;
+    double polling = run_polling(num_of_changed);
+    CHECK_EQ(changes_seen, (uint64_t)num_of_changed * NUM_OF_PASSES);
+
+    // Clear the mask left set by the polling run.
+    rot_enc_process_changes();
+    changes_seen = 0;
+    uint32_t mismatches = 0;
+    double masked = run_dirty_mask(num_of_changed, &mismatches);
+    CHECK_EQ(changes_seen, (uint64_t)num_of_changed * NUM_OF_PASSES);
+    CHECK_EQ(mismatches, 0);
+
+    printf("%7u  %7.2f  %10.2f\n", (unsigned)num_of_changed, polling, masked);
+  }
+
+  return test_report("bench_process_changes");
+}
+
+
+// End of file. //
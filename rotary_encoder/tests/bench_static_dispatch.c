@@ -0,0 +1,156 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file bench_static_dispatch.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Compares the cost of an EXTI interrupt through the generated switch
+ * of rotary_encoder_static.h with rot_enc_callback(), for 8 encoders with
+ * edges landing on random encoders. Each ISR is wrapped in a function that
+ * is not inlined, so "make sizes" can report their code size.
+ */
+
+#define MAX_NUM_OF_ENCODERS   8
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_EDGES          1000000
+
+static GPIO_TypeDef port;
+
+#define ROT_ENC_STATIC_ENCODERS(X)  \
+  X(enc0, &port, 0, &port, 8)       \
+  X(enc1, &port, 1, &port, 9)       \
+  X(enc2, &port, 2, &port, 10)      \
+  X(enc3, &port, 3, &port, 11)      \
+  X(enc4, &port, 4, &port, 12)      \
+  X(enc5, &port, 5, &port, 13)      \
+  X(enc6, &port, 6, &port, 14)      \
+  X(enc7, &port, 7, &port, 15)
+#include "rotary_encoder_static.h"
+
+static rot_enc_handle_t *const encoders[MAX_NUM_OF_ENCODERS] =
+{
+  &rot_enc_enc0, &rot_enc_enc1, &rot_enc_enc2, &rot_enc_enc3,
+  &rot_enc_enc4, &rot_enc_enc5, &rot_enc_enc6, &rot_enc_enc7
+};
+
+// Port value and EXTI line of each edge, worked out before timing.
+static uint32_t edge_idr[NUM_OF_EDGES];
+static uint16_t edge_pin[NUM_OF_EDGES];
+
+
+void __attribute__((noinline)) static_isr(uint16_t GPIO_Pin)
+{
+  rot_enc_static_callback(GPIO_Pin);
+}
+
+
+void __attribute__((noinline)) registry_isr(uint16_t GPIO_Pin)
+{
+  rot_enc_callback(GPIO_Pin);
+}
+
+
+/**
+ * Runs every edge through an ISR.
+ * @param takes the ISR to call.
+ * @param takes an array to copy the final counters into.
+ * @return ns per ISR.
+ */
+static double run(void (*isr)(uint16_t),
+                  rot_enc_count_t counters[MAX_NUM_OF_ENCODERS])
+{
+  port.IDR = 0;
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    encoders[index]->counter = 0;
+    encoders[index]->old_state = 0;
+  }
+
+  double start = test_time_ns();
+  for (uint32_t edge = 0; edge < NUM_OF_EDGES; ++edge)
+  {
+    port.IDR = edge_idr[edge];
+    isr(edge_pin[edge]);
+  }
+  double ns = (test_time_ns() - start) / NUM_OF_EDGES;
+
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    counters[index] = encoders[index]->counter;
+  }
+  return ns;
+}
+
+
+int main(void)
+{
+  int32_t positions[MAX_NUM_OF_ENCODERS] = {0};
+  uint32_t idr = 0;
+
+  test_reset_driver();
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    encoders[index]->count_mode = ROT_ENC_UNBOUNDED;
+  }
+  CHECK(rot_enc_static_init());
+
+  // Random encoders, each mostly turning forwards.
+  for (uint32_t edge = 0; edge < NUM_OF_EDGES; ++edge)
+  {
+    uint32_t index = test_random() % MAX_NUM_OF_ENCODERS;
+    int32_t step = ((test_random() % 4U) == 0) ? -1 : 1;
+    uint8_t old_state = test_quadrature_state(positions[index]);
+    positions[index] += step;
+    uint8_t new_state = test_quadrature_state(positions[index]);
+
+    idr &= ~(uint32_t)(encoders[index]->pin_a | encoders[index]->pin_b);
+    idr |= (new_state & 0x2U) ? encoders[index]->pin_a : 0U;
+    idr |= (new_state & 0x1U) ? encoders[index]->pin_b : 0U;
+    edge_idr[edge] = idr;
+    edge_pin[edge] = ((old_state ^ new_state) & 0x2U) ?
+                     encoders[index]->pin_a : encoders[index]->pin_b;
+  }
+
+  rot_enc_count_t static_counters[MAX_NUM_OF_ENCODERS];
+  rot_enc_count_t registry_counters[MAX_NUM_OF_ENCODERS];
+  double static_ns = run(static_isr, static_counters);
+  double registry_ns = run(registry_isr, registry_counters);
+
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    CHECK_EQ(static_counters[index], (rot_enc_count_t)positions[index]);
+    CHECK_EQ(registry_counters[index], (rot_enc_count_t)positions[index]);
+  }
+
+  printf("bench_static_dispatch: ns per ISR, 8 encoders\n");
+  printf("rot_enc_callback()         %5.2f\n", registry_ns);
+  printf("rot_enc_static_callback()  %5.2f\n", static_ns);
+  return test_report("bench_static_dispatch");
+}
+
+
+// End of file. //
@@ -0,0 +1,208 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file rot_enc_test.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Host test support for the encoder driver. Builds the driver into
+ * the test, so file scope state can be reset between cases, and provides
+ * checks and pin helpers. Define any driver build options before including
+ * this header.
+ */
+
+#ifndef ROT_ENC_TEST_DOT_H
+#define ROT_ENC_TEST_DOT_H
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "gpio.h"
+#include "sim_hal.h"
+
+/**
+ * Direct port reads, through sim_port_read_hook when it is set.
+ */
+static inline uint32_t test_port_read(GPIO_TypeDef *port)
+{
+  return (sim_port_read_hook != NULL) ? sim_port_read_hook(port) : port->IDR;
+}
+
+#ifndef ROT_ENC_PORT_READ
+#define ROT_ENC_PORT_READ(port)   test_port_read(port)
+#endif
+
+#include "rotary_encoder.c"
+
+
+// Number of failed checks in this test.
+static int test_failures = 0;
+
+#define CHECK(condition)                                                     \
+  do                                                                         \
+  {                                                                          \
+    if (!(condition))                                                        \
+    {                                                                        \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);   \
+      ++test_failures;                                                       \
+    }                                                                        \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                           \
+  do                                                                         \
+  {                                                                          \
+    long long actual_value = (long long)(actual);                            \
+    long long expected_value = (long long)(expected);                        \
+    if (actual_value != expected_value)                                      \
+    {                                                                        \
+      printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,       \
+             #actual, actual_value, expected_value);                         \
+      ++test_failures;                                                       \
+    }                                                                        \
+  } while (0)
+
+
+/**
+ * Clears the registry and every queue, so the next case starts from a fresh
+ * driver.
+ */
+static inline void test_reset_driver(void)
+{
+  for (int index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    registered_handles[index] = NULL;
+  }
+  dirty_mask = 0;
+  button_queue_head = 0;
+  button_queue_tail = 0;
+#if ROT_ENC_EVENT_QUEUE_SIZE > 0
+  event_queue_head = 0;
+  event_queue_tail = 0;
+  dropped_events = 0;
+#endif
+  position_store = NULL;
+  telemetry_period = ROT_ENC_TELEMETRY_PERIOD_MS;
+  telemetry_last_time = 0;
+  sim_port_read_hook = NULL;
+  sim_tick = 0;
+  sim_exti.IMR = 0xFFFFU;
+  sim_exti.PR = 0;
+  sim_uart_clear();
+}
+
+
+/**
+ * @param takes a position in transitions, positive when incrementing.
+ * @return the A/B state at that position, in 0b000000AB format.
+ */
+static inline uint8_t test_quadrature_state(int32_t position)
+{
+  static const uint8_t sequence[4] = {0x0, 0x2, 0x3, 0x1};
+  return sequence[position & 3];
+}
+
+
+/**
+ * Sets pins A and B of an encoder in its ports' IDRs.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes the new state, in 0b000000AB format.
+ */
+static inline void test_set_pins(rot_enc_handle_t *handle_ptr, uint8_t state)
+{
+  handle_ptr->port_a->IDR = (state & 0x2U) ?
+                            (handle_ptr->port_a->IDR | handle_ptr->pin_a) :
+                            (handle_ptr->port_a->IDR & ~handle_ptr->pin_a);
+  handle_ptr->port_b->IDR = (state & 0x1U) ?
+                            (handle_ptr->port_b->IDR | handle_ptr->pin_b) :
+                            (handle_ptr->port_b->IDR & ~handle_ptr->pin_b);
+}
+
+
+/**
+ * Turns an EXTI driven encoder by a number of transitions, one interrupt
+ * per edge, advancing the tick between edges.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes a pointer to the encoder's position, updated on return.
+ * @param takes the number of transitions, negative when decrementing.
+ * @param takes the ticks between edges.
+ */
+static inline void test_turn(rot_enc_handle_t *handle_ptr,
+                             int32_t *position_ptr,
+                             int32_t transitions,
+                             uint32_t interval)
+{
+  int32_t step = (transitions < 0) ? -1 : 1;
+
+  for (int32_t done = 0; done != transitions; done += step)
+  {
+    uint8_t old_state = test_quadrature_state(*position_ptr);
+    *position_ptr += step;
+    uint8_t new_state = test_quadrature_state(*position_ptr);
+
+    sim_tick += interval;
+    test_set_pins(handle_ptr, new_state);
+    rot_enc_callback(((old_state ^ new_state) & 0x2U) ? handle_ptr->pin_a :
+                                                         handle_ptr->pin_b);
+  }
+}
+
+
+/**
+ * Deterministic pseudo random numbers, so results are repeatable.
+ * @return a number from 0 to 0x7FFF.
+ */
+static inline uint32_t test_random(void)
+{
+  static uint32_t seed = 12345U;
+  seed = seed * 1103515245U + 12345U;
+  return (seed >> 16) & 0x7FFFU;
+}
+
+
+/**
+ * @return a monotonic time in nanoseconds, for benchmarks.
+ */
+static inline double test_time_ns(void)
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+
+/**
+ * Prints the result of a test.
+ * @param takes the test name.
+ * @return the exit status, 0 if every check passed.
+ */
+static inline int test_report(const char *name)
+{
+  printf("%s: %s\n", name, (test_failures == 0) ? "passed" : "FAILED");
+  return (test_failures == 0) ? 0 : 1;
+}
+
+#endif // ROT_ENC_TEST_DOT_H
+
+
+// End of file. //
@@ -0,0 +1,217 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file sim_encoder.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Timing simulation of an EXTI driven encoder, for host tests. Edges
+ * happen at given times in nanoseconds, each pends its EXTI line, and pended
+ * lines are serviced by rot_enc_callback() after an interrupt latency. Every
+ * port read takes time, so edges can land while the driver is reading the
+ * pins, as they do on the target. An index pulse can be generated once per
+ * revolution. Include after rot_enc_test.h.
+ */
+
+#ifndef SIM_ENCODER_DOT_H
+#define SIM_ENCODER_DOT_H
+
+#include <stdlib.h>
+
+/**
+ * Simulated encoder, its wiring, and the timing of the CPU servicing it.
+ */
+typedef struct
+{
+    rot_enc_handle_t *handle_ptr;
+
+    // Time of each edge, ascending, and its step, -1 or 1.
+    const double *edge_time;
+    const int8_t *edge_step;
+    uint32_t num_of_edges;
+
+    // Time taken by each port read, from entry to the ISR to the first read,
+    // and from the last read to the next ISR.
+    double read_ns;
+    double latency_ns;
+    double exit_ns;
+
+    // Transitions per revolution, or 0 for no index pulse. The index pin is
+    // high for the one transition at each multiple of index_period, and its
+    // rising edge pends the handle's index_pin line.
+    int32_t index_period;
+
+    // Extra latency added to a random fraction of ISR entries, modelling
+    // higher priority interrupts or critical sections.
+    double stall_ns;
+    uint32_t stall_per_thousand;
+
+    // Current time, and edges up to the read and pend cursors.
+    double now;
+    uint32_t read_cursor;
+    int32_t read_position;
+    uint32_t pend_cursor;
+    int32_t pend_position;
+
+    // ISR runs, for load measurements.
+    uint32_t isr_calls;
+}sim_encoder_t;
+
+static sim_encoder_t *sim_encoder_active = NULL;
+
+
+/**
+ * Fills in edge times for a spin of num_of_edges transitions at a mean
+ * interval, with each interval varied by up to +/- jitter.
+ * @param takes arrays for the edge times and steps.
+ * @param takes the number of edges.
+ * @param takes the step of every edge, -1 or 1.
+ * @param takes the mean interval between edges in ns.
+ * @param takes the maximum variation of each interval in ns.
+ */
+static inline void sim_encoder_spin(double *edge_time,
+                                    int8_t *edge_step,
+                                    uint32_t num_of_edges,
+                                    int8_t step,
+                                    double interval_ns,
+                                    double jitter_ns)
+{
+  double time = interval_ns;
+
+  for (uint32_t index = 0; index < num_of_edges; ++index)
+  {
+    edge_time[index] = time;
+    edge_step[index] = step;
+    time += interval_ns +
+            jitter_ns * (((double)test_random() / 16383.5) - 1.0);
+  }
+}
+
+
+/**
+ * Port read hook. Samples the pins at the current time, then advances the
+ * time by the cost of the read.
+ */
+static inline uint32_t sim_encoder_read(GPIO_TypeDef *port)
+{
+  sim_encoder_t *sim_ptr = sim_encoder_active;
+  rot_enc_handle_t *handle_ptr = sim_ptr->handle_ptr;
+
+  while (sim_ptr->read_cursor < sim_ptr->num_of_edges &&
+         sim_ptr->edge_time[sim_ptr->read_cursor] <= sim_ptr->now)
+  {
+    sim_ptr->read_position += sim_ptr->edge_step[sim_ptr->read_cursor++];
+  }
+  sim_ptr->now += sim_ptr->read_ns;
+
+  uint8_t state = test_quadrature_state(sim_ptr->read_position);
+  uint32_t idr = 0;
+  if (port == handle_ptr->port_a && (state & 0x2U))
+  {
+    idr |= handle_ptr->pin_a;
+  }
+  if (port == handle_ptr->port_b && (state & 0x1U))
+  {
+    idr |= handle_ptr->pin_b;
+  }
+  if (port == handle_ptr->index_port && sim_ptr->index_period != 0 &&
+      (sim_ptr->read_position % sim_ptr->index_period) == 0)
+  {
+    idr |= handle_ptr->index_pin;
+  }
+  return idr;
+}
+
+
+/**
+ * Runs the simulation until every edge has been serviced. The encoder must
+ * be initialised at position 0, state 0b00, before calling this.
+ * @param takes a pointer to a sim_encoder_t object.
+ */
+static inline void sim_encoder_run(sim_encoder_t *sim_ptr)
+{
+  rot_enc_handle_t *handle_ptr = sim_ptr->handle_ptr;
+  uint32_t pending = 0;
+
+  sim_encoder_active = sim_ptr;
+  sim_port_read_hook = sim_encoder_read;
+
+  for (;;)
+  {
+    // Pend the line of every edge that has happened by now.
+    while (sim_ptr->pend_cursor < sim_ptr->num_of_edges &&
+           sim_ptr->edge_time[sim_ptr->pend_cursor] <= sim_ptr->now)
+    {
+      int8_t step = sim_ptr->edge_step[sim_ptr->pend_cursor++];
+      uint8_t old_state = test_quadrature_state(sim_ptr->pend_position);
+      sim_ptr->pend_position += step;
+      uint8_t new_state = test_quadrature_state(sim_ptr->pend_position);
+      pending |= ((old_state ^ new_state) & 0x2U) ? handle_ptr->pin_a :
+                                                    handle_ptr->pin_b;
+      if (sim_ptr->index_period != 0 &&
+          (sim_ptr->pend_position % sim_ptr->index_period) == 0)
+      {
+        pending |= handle_ptr->index_pin;
+      }
+    }
+
+    if (pending == 0)
+    {
+      if (sim_ptr->pend_cursor == sim_ptr->num_of_edges)
+      {
+        break;
+      }
+
+      // Idle until the next edge, then take the interrupt.
+      sim_ptr->now = sim_ptr->edge_time[sim_ptr->pend_cursor];
+      continue;
+    }
+
+    sim_ptr->now += sim_ptr->latency_ns;
+    if (sim_ptr->stall_per_thousand != 0 &&
+        (test_random() % 1000U) < sim_ptr->stall_per_thousand)
+    {
+      sim_ptr->now += sim_ptr->stall_ns;
+    }
+
+    // The EXTI handler clears the pending bit before the callback, lowest
+    // line first.
+    uint16_t pin = (uint16_t)(pending & -pending);
+    pending &= ~(uint32_t)pin;
+    if (sim_exti.IMR & pin)
+    {
+      ++sim_ptr->isr_calls;
+      rot_enc_callback(pin);
+    }
+    sim_ptr->now += sim_ptr->exit_ns;
+  }
+
+  sim_port_read_hook = NULL;
+  sim_encoder_active = NULL;
+}
+
+#endif // SIM_ENCODER_DOT_H
+
+
+// End of file. //
@@ -0,0 +1,161 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file sim_flash_store.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief File backed flash simulation, as a rot_enc_store_t for host tests.
+ * Each slot is a record in the file, so values survive a simulated reboot
+ * the way they would survive a brown-out on the target, and every write is
+ * counted to measure flash wear. Include after rot_enc_test.h.
+ */
+
+#ifndef SIM_FLASH_STORE_DOT_H
+#define SIM_FLASH_STORE_DOT_H
+
+// Marks a record that has been written, as erased flash reads 0xFF.
+#define SIM_FLASH_RECORD_MAGIC  0x464C5348UL
+
+/**
+ * Record for one slot, as it would be laid out in a flash page.
+ */
+typedef struct
+{
+    uint32_t magic;
+    int64_t value;
+}sim_flash_record_t;
+
+static FILE *sim_flash_file = NULL;
+static uint32_t sim_flash_writes[MAX_NUM_OF_ENCODERS];
+
+
+/**
+ * Reads a slot's record from the file.
+ * @param takes the slot number, the encoder id.
+ * @param takes a pointer to write the value to.
+ * @return true if the slot has been written, false if it is erased.
+ */
+static bool sim_flash_read(uint8_t slot, rot_enc_count_t *value_ptr)
+{
+  sim_flash_record_t record;
+
+  if (slot >= MAX_NUM_OF_ENCODERS ||
+      fseek(sim_flash_file, (long)(slot * sizeof(record)), SEEK_SET) != 0 ||
+      fread(&record, sizeof(record), 1, sim_flash_file) != 1 ||
+      record.magic != SIM_FLASH_RECORD_MAGIC)
+  {
+    return false;
+  }
+  *value_ptr = (rot_enc_count_t)record.value;
+  return true;
+}
+
+
+/**
+ * Erases and programs a slot's record, flushing it to the file.
+ * @param takes the slot number, the encoder id.
+ * @param takes the value to write.
+ */
+static void sim_flash_write(uint8_t slot, rot_enc_count_t value)
+{
+  sim_flash_record_t record =
+  {
+    .magic = SIM_FLASH_RECORD_MAGIC,
+    .value = value
+  };
+
+  if (slot >= MAX_NUM_OF_ENCODERS ||
+      fseek(sim_flash_file, (long)(slot * sizeof(record)), SEEK_SET) != 0)
+  {
+    return;
+  }
+  fwrite(&record, sizeof(record), 1, sim_flash_file);
+  fflush(sim_flash_file);
+  ++sim_flash_writes[slot];
+}
+
+
+/**
+ * Store to pass to rot_enc_set_store(), once sim_flash_open() has been
+ * called.
+ */
+static const rot_enc_store_t sim_flash_store =
+{
+  .read = sim_flash_read,
+  .write = sim_flash_write
+};
+
+
+/**
+ * Opens the flash file, keeping its contents, as at power up.
+ * @param takes the path of the file.
+ * @param takes true to erase every record first, as for a new device.
+ * @return true if the file was opened.
+ */
+static bool sim_flash_open(const char *path, bool erase)
+{
+  if (sim_flash_file != NULL)
+  {
+    fclose(sim_flash_file);
+  }
+
+  sim_flash_file = erase ? NULL : fopen(path, "r+b");
+  if (sim_flash_file == NULL)
+  {
+    sim_flash_file = fopen(path, "w+b");
+    if (sim_flash_file == NULL)
+    {
+      return false;
+    }
+
+    sim_flash_record_t erased;
+    memset(&erased, 0xFF, sizeof(erased));
+    for (uint8_t slot = 0; slot < MAX_NUM_OF_ENCODERS; ++slot)
+    {
+      fwrite(&erased, sizeof(erased), 1, sim_flash_file);
+    }
+    fflush(sim_flash_file);
+  }
+
+  memset(sim_flash_writes, 0, sizeof(sim_flash_writes));
+  return true;
+}
+
+
+/**
+ * Closes the flash file, as at power down.
+ */
+static void sim_flash_close(void)
+{
+  if (sim_flash_file != NULL)
+  {
+    fclose(sim_flash_file);
+    sim_flash_file = NULL;
+  }
+}
+
+#endif // SIM_FLASH_STORE_DOT_H
+
+
+// End of file. //
@@ -0,0 +1,102 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file sim_hal.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Simulated peripherals and HAL functions for host builds of the
+ * encoder driver and log system. UART output is captured in a buffer so
+ * tests can check what was logged.
+ */
+
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "sim_hal.h"
+
+EXTI_TypeDef sim_exti;
+RTC_TypeDef sim_rtc;
+volatile uint32_t sim_tick = 0;
+uint32_t (*sim_port_read_hook)(GPIO_TypeDef *port) = NULL;
+
+uint8_t sim_uart_buffer[SIM_UART_BUFFER_SIZE];
+uint32_t sim_uart_length = 0;
+
+
+/*
+ * @return the simulated millisecond tick.
+ */
+uint32_t HAL_GetTick(void)
+{
+  return sim_tick;
+}
+
+
+/*
+ * Reads a pin as the HAL does, with a call and a parameter check, so host
+ * benchmarks see the cost of not inlining it.
+ */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  if (GPIO_Pin == 0)
+  {
+    return GPIO_PIN_RESET;
+  }
+  uint32_t idr = (sim_port_read_hook != NULL) ? sim_port_read_hook(GPIOx) :
+                                                GPIOx->IDR;
+  return ((idr & GPIO_Pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+
+/*
+ * Appends transmitted bytes to sim_uart_buffer, dropping any that do not
+ * fit.
+ */
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart,
+                                    const uint8_t *pData,
+                                    uint16_t Size,
+                                    uint32_t Timeout)
+{
+  (void)huart;
+  (void)Timeout;
+
+  uint32_t space = SIM_UART_BUFFER_SIZE - sim_uart_length;
+  uint32_t length = (Size < space) ? Size : space;
+
+  memcpy(&sim_uart_buffer[sim_uart_length], pData, length);
+  sim_uart_length += length;
+  return HAL_OK;
+}
+
+
+/*
+ * Clears the captured UART output.
+ */
+void sim_uart_clear(void)
+{
+  sim_uart_length = 0;
+}
+
+
+// End of file. //
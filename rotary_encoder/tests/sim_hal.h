@@ -0,0 +1,61 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file sim_hal.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Test access to the simulated HAL in sim_hal.c.
+ */
+
+#ifndef SIM_HAL_DOT_H
+#define SIM_HAL_DOT_H
+
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+
+#define SIM_UART_BUFFER_SIZE  65536
+
+/**
+ * Bytes sent through HAL_UART_Transmit(), and how many there are.
+ */
+extern uint8_t sim_uart_buffer[SIM_UART_BUFFER_SIZE];
+extern uint32_t sim_uart_length;
+
+/**
+ * Optional hook for port reads, for simulations where the pins change while
+ * the driver is reading them. NULL reads the port's IDR. Used by
+ * HAL_GPIO_ReadPin(), and by the driver's direct reads in rot_enc_test.h.
+ */
+extern uint32_t (*sim_port_read_hook)(GPIO_TypeDef *port);
+
+/**
+ * Clears the captured UART output.
+ */
+void sim_uart_clear(void);
+
+#endif // SIM_HAL_DOT_H
+
+
+// End of file. //
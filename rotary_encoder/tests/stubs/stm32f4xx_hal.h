@@ -0,0 +1,167 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file stm32f4xx_hal.h
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Minimal stand-in for the STM32F4 HAL, so the encoder driver and log
+ * system can be built and tested on a PC. Peripherals are plain structs in
+ * RAM, see sim_hal.c, and the tick is advanced by the test.
+ */
+
+#ifndef STM32F4XX_HAL_DOT_H
+#define STM32F4XX_HAL_DOT_H
+
+#include <stdint.h>
+
+#define GPIO_PIN_0    ((uint16_t)0x0001)
+#define GPIO_PIN_1    ((uint16_t)0x0002)
+#define GPIO_PIN_2    ((uint16_t)0x0004)
+#define GPIO_PIN_3    ((uint16_t)0x0008)
+#define GPIO_PIN_4    ((uint16_t)0x0010)
+#define GPIO_PIN_5    ((uint16_t)0x0020)
+#define GPIO_PIN_6    ((uint16_t)0x0040)
+#define GPIO_PIN_7    ((uint16_t)0x0080)
+#define GPIO_PIN_8    ((uint16_t)0x0100)
+#define GPIO_PIN_9    ((uint16_t)0x0200)
+#define GPIO_PIN_10   ((uint16_t)0x0400)
+#define GPIO_PIN_11   ((uint16_t)0x0800)
+#define GPIO_PIN_12   ((uint16_t)0x1000)
+#define GPIO_PIN_13   ((uint16_t)0x2000)
+#define GPIO_PIN_14   ((uint16_t)0x4000)
+#define GPIO_PIN_15   ((uint16_t)0x8000)
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    volatile uint32_t MODER;
+    volatile uint32_t OTYPER;
+    volatile uint32_t OSPEEDR;
+    volatile uint32_t PUPDR;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t CNT;
+    volatile uint32_t ARR;
+} TIM_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t IMR;
+    volatile uint32_t EMR;
+    volatile uint32_t RTSR;
+    volatile uint32_t FTSR;
+    volatile uint32_t SWIER;
+    volatile uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t BKP0R;
+    volatile uint32_t BKP1R;
+    volatile uint32_t BKP2R;
+    volatile uint32_t BKP3R;
+    volatile uint32_t BKP4R;
+    volatile uint32_t BKP5R;
+    volatile uint32_t BKP6R;
+    volatile uint32_t BKP7R;
+    volatile uint32_t BKP8R;
+    volatile uint32_t BKP9R;
+    volatile uint32_t BKP10R;
+    volatile uint32_t BKP11R;
+    volatile uint32_t BKP12R;
+    volatile uint32_t BKP13R;
+    volatile uint32_t BKP14R;
+    volatile uint32_t BKP15R;
+    volatile uint32_t BKP16R;
+    volatile uint32_t BKP17R;
+    volatile uint32_t BKP18R;
+    volatile uint32_t BKP19R;
+} RTC_TypeDef;
+
+typedef struct
+{
+    uint32_t instance;
+} UART_HandleTypeDef;
+
+
+// Simulated peripherals and tick, defined in sim_hal.c.
+extern EXTI_TypeDef sim_exti;
+extern RTC_TypeDef sim_rtc;
+extern volatile uint32_t sim_tick;
+
+#define EXTI    (&sim_exti)
+#define RTC     (&sim_rtc)
+
+
+uint32_t HAL_GetTick(void);
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart,
+                                    const uint8_t *pData,
+                                    uint16_t Size,
+                                    uint32_t Timeout);
+
+
+// A PC runs the test single threaded, so the CMSIS intrinsics do nothing.
+static inline void __DMB(void)
+{
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline uint32_t __get_PRIMASK(void)
+{
+  return 0;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+  (void)primask;
+}
+
+#endif // STM32F4XX_HAL_DOT_H
+
+
+// End of file. //
@@ -0,0 +1,136 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_accel.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Spins a simulated encoder at several rates, and checks the step
+ * size the acceleration curve gives at each.
+ */
+
+#include "rot_enc_test.h"
+
+static GPIO_TypeDef port;
+
+// 1 kHz timestamp, so intervals are in ms.
+static const rot_enc_accel_step_t curve[] = {{10, 50}, {30, 10}, {80, 4}};
+
+
+/**
+ * Spins an encoder at a steady rate, after settling at that rate, and
+ * returns the counter change.
+ * @param takes true to enable acceleration.
+ * @param takes the number of transitions, negative when decrementing.
+ * @param takes the ms between transitions.
+ * @return the counter change over the spin.
+ */
+static int32_t spin(bool accel_enabled, int32_t transitions, uint32_t interval)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .accel_enabled = accel_enabled,
+    .accel_curve = curve,
+    .accel_curve_len = sizeof(curve) / sizeof(curve[0])
+  };
+  CHECK(init_rotary_encoder(&encoder));
+
+  int32_t position = 0;
+  test_turn(&encoder, &position, transitions, interval);
+  return rot_enc_get_count_value(&encoder);
+}
+
+
+static void test_steady_rates(void)
+{
+  // Faster than each entry's max_interval takes that entry's multiplier,
+  // slower than every entry counts 1.
+  CHECK_EQ(spin(true, 20, 5), 20 * 50);
+  CHECK_EQ(spin(true, 20, 10), 20 * 50);
+  CHECK_EQ(spin(true, 20, 11), 20 * 10);
+  CHECK_EQ(spin(true, 20, 30), 20 * 10);
+  CHECK_EQ(spin(true, 20, 50), 20 * 4);
+  CHECK_EQ(spin(true, 20, 80), 20 * 4);
+  CHECK_EQ(spin(true, 20, 81), 20);
+  CHECK_EQ(spin(true, 20, 500), 20);
+  CHECK_EQ(spin(true, -20, 5), -20 * 50);
+  CHECK_EQ(spin(true, -20, 50), -20 * 4);
+
+  // Disabled, the rate makes no difference.
+  CHECK_EQ(spin(false, 20, 5), 20);
+}
+
+
+static void test_speeding_up_and_slowing_down(void)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .accel_enabled = true,
+    .accel_curve = curve,
+    .accel_curve_len = sizeof(curve) / sizeof(curve[0])
+  };
+  CHECK(init_rotary_encoder(&encoder));
+
+  int32_t position = 0;
+  test_turn(&encoder, &position, 4, 200);
+  CHECK_EQ(encoder.counter, 4);
+  test_turn(&encoder, &position, 4, 60);
+  CHECK_EQ(encoder.counter, 4 + 4 * 4);
+  test_turn(&encoder, &position, 4, 20);
+  CHECK_EQ(encoder.counter, 4 + 4 * 4 + 4 * 10);
+  test_turn(&encoder, &position, 4, 2);
+  CHECK_EQ(encoder.counter, 4 + 4 * 4 + 4 * 10 + 4 * 50);
+
+  // A pause before turning back drops straight to single steps.
+  sim_tick += 1000;
+  test_turn(&encoder, &position, -1, 0);
+  CHECK_EQ(encoder.counter, 4 + 4 * 4 + 4 * 10 + 4 * 50 - 1);
+}
+
+
+int main(void)
+{
+  test_steady_rates();
+  test_speeding_up_and_slowing_down();
+  return test_report("test_accel");
+}
+
+
+// End of file. //
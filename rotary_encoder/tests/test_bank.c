@@ -0,0 +1,175 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_bank.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks that a bank with a bad handle registers none of its
+ * handles, and that bit-parallel polling counts every encoder in a bank.
+ */
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_ENCODERS   4
+#define NUM_OF_POLLS      10000
+
+static GPIO_TypeDef port;
+static GPIO_TypeDef other_port;
+static rot_enc_handle_t encoders[NUM_OF_ENCODERS];
+static rot_enc_handle_t *handles[NUM_OF_ENCODERS];
+
+
+/**
+ * Sets up a bank of encoders with A on pins 0-3 and B on pins 4-7.
+ * @param takes a pointer to the bank to set up.
+ */
+static void setup_bank(rot_enc_bank_t *bank_ptr)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  for (int index = 0; index < NUM_OF_ENCODERS; ++index)
+  {
+    rot_enc_handle_t encoder =
+    {
+      .pin_a = (uint16_t)(1U << index),
+      .pin_b = (uint16_t)(1U << (index + 4)),
+      .port_a = &port,
+      .port_b = &port,
+      .count_mode = ROT_ENC_UNBOUNDED
+    };
+    encoders[index] = encoder;
+    handles[index] = &encoders[index];
+  }
+
+  rot_enc_bank_t bank =
+  {
+    .port = &port,
+    .handles = handles,
+    .num_of_handles = NUM_OF_ENCODERS,
+    .b_offset = 4
+  };
+  *bank_ptr = bank;
+}
+
+
+/**
+ * @return the number of handles in the registry.
+ */
+static int registered_count(void)
+{
+  int count = 0;
+  for (int index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    count += (registered_handles[index] != NULL);
+  }
+  return count;
+}
+
+
+static void test_bad_handle_registers_nothing(void)
+{
+  rot_enc_bank_t bank;
+
+  // The last handle is on the wrong port.
+  setup_bank(&bank);
+  encoders[NUM_OF_ENCODERS - 1].port_b = &other_port;
+  CHECK(!init_rotary_encoder_bank(&bank));
+  CHECK_EQ(registered_count(), 0);
+
+  // The last handle's B pin is not at b_offset.
+  setup_bank(&bank);
+  encoders[NUM_OF_ENCODERS - 1].pin_b = GPIO_PIN_15;
+  CHECK(!init_rotary_encoder_bank(&bank));
+  CHECK_EQ(registered_count(), 0);
+
+  // Too few free registry slots for the whole bank.
+  setup_bank(&bank);
+  rot_enc_handle_t filler[MAX_NUM_OF_ENCODERS - NUM_OF_ENCODERS + 1];
+  for (int index = 0; index < MAX_NUM_OF_ENCODERS - NUM_OF_ENCODERS + 1;
+       ++index)
+  {
+    rot_enc_handle_t encoder =
+    {
+      .pin_a = GPIO_PIN_14,
+      .pin_b = GPIO_PIN_15,
+      .port_a = &other_port,
+      .port_b = &other_port
+    };
+    filler[index] = encoder;
+    CHECK(init_rotary_encoder(&filler[index]));
+  }
+  CHECK(!init_rotary_encoder_bank(&bank));
+  CHECK_EQ(registered_count(), MAX_NUM_OF_ENCODERS - NUM_OF_ENCODERS + 1);
+
+  setup_bank(&bank);
+  CHECK(init_rotary_encoder_bank(&bank));
+  CHECK_EQ(registered_count(), NUM_OF_ENCODERS);
+}
+
+
+static void test_polling_counts_every_encoder(void)
+{
+  rot_enc_bank_t bank;
+  int32_t positions[NUM_OF_ENCODERS] = {0};
+
+  setup_bank(&bank);
+  CHECK(init_rotary_encoder_bank(&bank));
+
+  // Each encoder wanders back and forth, moving at most once per poll.
+  for (int poll = 0; poll < NUM_OF_POLLS; ++poll)
+  {
+    uint32_t idr = 0;
+    for (int index = 0; index < NUM_OF_ENCODERS; ++index)
+    {
+      uint32_t move = test_random() % 8U;
+      positions[index] += (move < 3) ? 1 : (move < 5) ? -1 : 0;
+
+      uint8_t state = test_quadrature_state(positions[index]);
+      idr |= ((state >> 1) & 1U) << index;
+      idr |= (state & 1U) << (index + 4);
+    }
+    port.IDR = idr;
+    ++sim_tick;
+    rot_enc_poll_bank(&bank);
+  }
+
+  for (int index = 0; index < NUM_OF_ENCODERS; ++index)
+  {
+    CHECK_EQ(rot_enc_get_count_value(&encoders[index]), positions[index]);
+    CHECK_EQ(encoders[index].stats.invalid_transitions, 0);
+  }
+}
+
+
+int main(void)
+{
+  test_bad_handle_registers_nothing();
+  test_polling_counts_every_encoder();
+  return test_report("test_bank");
+}
+
+
+// End of file. //
@@ -0,0 +1,204 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_button.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Simulates a bouncing push button sampled by rot_enc_tick(), and
+ * checks the gestures reported for clicks, double clicks and long presses.
+ */
+
+#include "rot_enc_test.h"
+
+#define MAX_EVENTS    16
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static rot_enc_button_event_type_t events[MAX_EVENTS];
+static int num_of_events;
+
+
+/**
+ * Registers a fresh encoder with an active low button on pin 2.
+ * @param takes the gesture that resets the counter.
+ */
+static void setup(rot_enc_button_action_t button_action)
+{
+  test_reset_driver();
+  port.IDR = GPIO_PIN_2;
+  num_of_events = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .button_pin = GPIO_PIN_2,
+    .port_a = &port,
+    .port_b = &port,
+    .button_port = &port,
+    .button_action = button_action,
+    .counter = 7,
+    .counter_max = 100
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+}
+
+
+/**
+ * Runs rot_enc_tick() once a millisecond, collecting button events.
+ * @param takes the number of ms to run for.
+ */
+static void run(uint32_t ms)
+{
+  for (uint32_t tick = 0; tick < ms; ++tick)
+  {
+    ++sim_tick;
+    rot_enc_tick();
+
+    rot_enc_button_event_t event;
+    while (rot_enc_get_button_event(&event))
+    {
+      CHECK_EQ(event.encoder_id, encoder.id);
+      if (num_of_events < MAX_EVENTS)
+      {
+        events[num_of_events++] = event.type;
+      }
+    }
+  }
+}
+
+
+/**
+ * Moves the button to a new level through 8 ms of contact bounce, then holds
+ * it there.
+ * @param takes true to press, false to release.
+ * @param takes the ms to hold the new level for, after the bounce.
+ */
+static void bounce_to(bool pressed, uint32_t ms)
+{
+  for (int tick = 0; tick < 8; ++tick)
+  {
+    port.IDR = (test_random() & 1U) ? GPIO_PIN_2 : 0;
+    run(1);
+  }
+  port.IDR = pressed ? 0 : GPIO_PIN_2;
+  run(ms);
+}
+
+
+static void test_click(void)
+{
+  setup(ROT_ENC_RESET_ON_CLICK);
+  bounce_to(true, 100);
+  bounce_to(false, 100);
+
+  // Not reported until no second click can follow.
+  CHECK_EQ(num_of_events, 0);
+  CHECK_EQ(encoder.counter, 7);
+  run(ROT_ENC_DOUBLE_CLICK_MS);
+  CHECK_EQ(num_of_events, 1);
+  CHECK_EQ(events[0], ROT_ENC_BUTTON_CLICK);
+  CHECK_EQ(encoder.counter, 0);
+}
+
+
+static void test_double_click(void)
+{
+  setup(ROT_ENC_RESET_ON_DOUBLE_CLICK);
+  bounce_to(true, 80);
+  bounce_to(false, 100);
+  bounce_to(true, 80);
+  bounce_to(false, 1000);
+  CHECK_EQ(num_of_events, 1);
+  CHECK_EQ(events[0], ROT_ENC_BUTTON_DOUBLE_CLICK);
+  CHECK_EQ(encoder.counter, 0);
+}
+
+
+static void test_long_press(void)
+{
+  setup(ROT_ENC_RESET_ON_LONG_PRESS);
+  bounce_to(true, 1300);
+  bounce_to(false, 1000);
+
+  // Long press at 800 ms, then repeats every 200 ms while held.
+  CHECK_EQ(num_of_events, 3);
+  CHECK_EQ(events[0], ROT_ENC_BUTTON_LONG_PRESS);
+  CHECK_EQ(events[1], ROT_ENC_BUTTON_HOLD_REPEAT);
+  CHECK_EQ(events[2], ROT_ENC_BUTTON_HOLD_REPEAT);
+  CHECK_EQ(encoder.counter, 0);
+}
+
+
+static void test_click_then_long_press(void)
+{
+  setup(ROT_ENC_RESET_NEVER);
+  bounce_to(true, 80);
+  bounce_to(false, 100);
+  bounce_to(true, 900);
+  bounce_to(false, 1000);
+
+  // The first click must not be lost when the second press is held.
+  CHECK_EQ(num_of_events, 2);
+  CHECK_EQ(events[0], ROT_ENC_BUTTON_CLICK);
+  CHECK_EQ(events[1], ROT_ENC_BUTTON_LONG_PRESS);
+  CHECK_EQ(encoder.counter, 7);
+}
+
+
+static void test_glitch_ignored(void)
+{
+  setup(ROT_ENC_RESET_ON_PRESS);
+
+  // Noise shorter than the debounce time.
+  for (int burst = 0; burst < 10; ++burst)
+  {
+    port.IDR = 0;
+    run(ROT_ENC_DEBOUNCE_MS / 2);
+    port.IDR = GPIO_PIN_2;
+    run(50);
+  }
+  CHECK_EQ(num_of_events, 0);
+  CHECK_EQ(encoder.counter, 7);
+
+  // A real press resets straight away.
+  bounce_to(true, ROT_ENC_DEBOUNCE_MS);
+  CHECK_EQ(encoder.counter, 0);
+}
+
+
+int main(void)
+{
+  test_click();
+  test_double_click();
+  test_long_press();
+  test_click_then_long_press();
+  test_glitch_ignored();
+  return test_report("test_button");
+}
+
+
+// End of file. //
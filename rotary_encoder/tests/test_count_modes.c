@@ -0,0 +1,180 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_count_modes.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks the saturate, wrap and unbounded count modes at and across
+ * counter_min and counter_max, with single and scaled steps, and a handle
+ * initialised positionally against the original struct layout.
+ */
+
+#include "rot_enc_test.h"
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static int32_t position;
+
+
+/**
+ * Registers a fresh encoder.
+ * @param takes the count mode.
+ * @param takes counter_min and counter_max.
+ * @param takes the step multiplier, 0 for single steps.
+ */
+static void setup(rot_enc_count_mode_t count_mode,
+                  rot_enc_count_t counter_min,
+                  rot_enc_count_t counter_max,
+                  int16_t step_multiplier)
+{
+  test_reset_driver();
+  port.IDR = 0;
+  position = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .counter = (counter_min > 0) ? counter_min : 0,
+    .counter_min = counter_min,
+    .counter_max = counter_max,
+    .count_mode = count_mode,
+    .step_multiplier = step_multiplier
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+}
+
+
+static void test_saturate(void)
+{
+  setup(ROT_ENC_SATURATE, 0, 10, 0);
+  test_turn(&encoder, &position, 15, 1);
+  CHECK_EQ(encoder.counter, 10);
+
+  // Stopped at the limit, so turning on is not a change.
+  rot_enc_process_changes();
+  test_turn(&encoder, &position, 3, 1);
+  CHECK_EQ(rot_enc_get_dirty_mask(), 0);
+
+  // Turning back moves off the limit straight away.
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, 9);
+  test_turn(&encoder, &position, -20, 1);
+  CHECK_EQ(encoder.counter, 0);
+
+  // Steps larger than the range stop at the limits too.
+  setup(ROT_ENC_SATURATE, -5, 5, 7);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 5);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, -2);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, -5);
+}
+
+
+static void test_wrap(void)
+{
+  setup(ROT_ENC_WRAP, 0, 9, 0);
+  test_turn(&encoder, &position, 9, 1);
+  CHECK_EQ(encoder.counter, 9);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 0);
+  test_turn(&encoder, &position, 12, 1);
+  CHECK_EQ(encoder.counter, 2);
+  test_turn(&encoder, &position, -3, 1);
+  CHECK_EQ(encoder.counter, 9);
+
+  // Steps larger than the range wrap by the remainder.
+  setup(ROT_ENC_WRAP, 0, 9, 23);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 3);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, 0);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, 7);
+
+  // A range either side of 0.
+  setup(ROT_ENC_WRAP, -5, 5, 0);
+  test_turn(&encoder, &position, 6, 1);
+  CHECK_EQ(encoder.counter, -5);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, 5);
+}
+
+
+static void test_unbounded(void)
+{
+  setup(ROT_ENC_UNBOUNDED, 0, 10, 0);
+  test_turn(&encoder, &position, 15, 1);
+  CHECK_EQ(encoder.counter, 15);
+  test_turn(&encoder, &position, -30, 1);
+  CHECK_EQ(encoder.counter, -15);
+}
+
+
+/**
+ * A handle initialised positionally, against the original layout of the
+ * struct, still gets its pins, ports and limits.
+ */
+static void test_positional_initialiser(void)
+{
+  test_reset_driver();
+  port.IDR = 0;
+  position = 0;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+  rot_enc_handle_t positional =
+  {
+    GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_2, &port, &port, 0, 0, 100, -100
+  };
+#pragma GCC diagnostic pop
+
+  encoder = positional;
+  CHECK(init_rotary_encoder(&encoder));
+  test_turn(&encoder, &position, 150, 1);
+  CHECK_EQ(encoder.counter, 100);
+  rot_enc_callback(GPIO_PIN_2);
+  CHECK_EQ(encoder.counter, 0);
+  test_turn(&encoder, &position, -150, 1);
+  CHECK_EQ(encoder.counter, -100);
+}
+
+
+int main(void)
+{
+  test_saturate();
+  test_wrap();
+  test_unbounded();
+  test_positional_initialiser();
+  return test_report("test_count_modes");
+}
+
+
+// End of file. //
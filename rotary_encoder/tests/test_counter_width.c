@@ -0,0 +1,146 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_counter_width.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Spins an encoder past the 16 bit range, and checks the counter at
+ * each ROT_ENC_COUNTER_BITS. Built once per width by the Makefile.
+ */
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_TRANSITIONS  100000
+
+#if ROT_ENC_COUNTER_BITS == 16
+#define COUNT_MAX   INT16_MAX
+#define COUNT_MIN   INT16_MIN
+#elif ROT_ENC_COUNTER_BITS == 32
+#define COUNT_MAX   INT32_MAX
+#define COUNT_MIN   INT32_MIN
+#else
+#define COUNT_MAX   INT64_MAX
+#define COUNT_MIN   INT64_MIN
+#endif
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static int32_t position;
+
+
+/**
+ * Registers a fresh encoder.
+ * @param takes the count mode.
+ * @param takes the starting counter value.
+ */
+static void setup(rot_enc_count_mode_t count_mode, rot_enc_count_t counter)
+{
+  test_reset_driver();
+  port.IDR = 0;
+  position = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .counter = counter,
+    .counter_max = COUNT_MAX,
+    .counter_min = COUNT_MIN,
+    .count_mode = count_mode
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+}
+
+
+static void test_spin_past_16_bits(void)
+{
+  setup(ROT_ENC_UNBOUNDED, 0);
+  test_turn(&encoder, &position, NUM_OF_TRANSITIONS, 0);
+#if ROT_ENC_COUNTER_BITS == 16
+  // Wraps round at the limits of int16_t.
+  CHECK_EQ(rot_enc_get_count_value(&encoder),
+           (int16_t)(uint16_t)NUM_OF_TRANSITIONS);
+#else
+  CHECK_EQ(rot_enc_get_count_value(&encoder), NUM_OF_TRANSITIONS);
+#endif
+
+  test_turn(&encoder, &position, -2 * NUM_OF_TRANSITIONS, 0);
+#if ROT_ENC_COUNTER_BITS == 16
+  CHECK_EQ(rot_enc_get_count_value(&encoder),
+           (int16_t)(uint16_t)-NUM_OF_TRANSITIONS);
+#else
+  CHECK_EQ(rot_enc_get_count_value(&encoder), -NUM_OF_TRANSITIONS);
+#endif
+
+  // position is 32 bits whatever the counter width.
+  CHECK_EQ(encoder.position, -NUM_OF_TRANSITIONS);
+}
+
+
+static void test_saturate_at_type_limits(void)
+{
+  // Adding a step to the type's maximum must not overflow before clamping.
+  setup(ROT_ENC_SATURATE, COUNT_MAX - 2);
+  test_turn(&encoder, &position, 10, 0);
+  CHECK(rot_enc_get_count_value(&encoder) == COUNT_MAX);
+
+  setup(ROT_ENC_SATURATE, COUNT_MIN + 2);
+  test_turn(&encoder, &position, -10, 0);
+  CHECK(rot_enc_get_count_value(&encoder) == COUNT_MIN);
+}
+
+
+#if ROT_ENC_COUNTER_BITS == 64
+static void test_cross_32_bit_limit(void)
+{
+  setup(ROT_ENC_SATURATE, (rot_enc_count_t)INT32_MAX - 10);
+  test_turn(&encoder, &position, 100, 0);
+  CHECK(rot_enc_get_count_value(&encoder) == (rot_enc_count_t)INT32_MAX + 90);
+
+  setup(ROT_ENC_SATURATE, (rot_enc_count_t)INT32_MIN + 10);
+  test_turn(&encoder, &position, -100, 0);
+  CHECK(rot_enc_get_count_value(&encoder) == (rot_enc_count_t)INT32_MIN - 90);
+}
+#endif
+
+
+int main(void)
+{
+  test_spin_past_16_bits();
+  test_saturate_at_type_limits();
+#if ROT_ENC_COUNTER_BITS == 64
+  test_cross_32_bit_limit();
+#endif
+
+  char name[32];
+  snprintf(name, sizeof(name), "test_counter_width_%d", ROT_ENC_COUNTER_BITS);
+  return test_report(name);
+}
+
+
+// End of file. //
@@ -0,0 +1,290 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+/**
+ * @file test_event_queue.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Builds the driver with the event queue enabled, and checks the
+ * queued ids, deltas and timestamps, drop counting when the queue is full,
+ * partial drains, and the events from resets, index pulses and timer reads.
+ */
+
+#define ROT_ENC_EVENT_QUEUE_SIZE  8
+
+#include "rot_enc_test.h"
+
+// One slot is kept free to tell a full queue from an empty one.
+#define QUEUE_CAPACITY  (ROT_ENC_EVENT_QUEUE_SIZE - 1)
+
+static GPIO_TypeDef port;
+static TIM_TypeDef timer;
+static rot_enc_event_t events[ROT_ENC_EVENT_QUEUE_SIZE];
+
+
+/**
+ * Registers an unbounded EXTI driven encoder on two pins of the test port.
+ * @param takes a pointer to a rot_enc_handle_t object, zeroed by the caller.
+ * @param takes the pin number of A. B is on the next pin.
+ */
+static void setup(rot_enc_handle_t *handle_ptr, uint8_t pin_number)
+{
+  handle_ptr->pin_a = (uint16_t)(1U << pin_number);
+  handle_ptr->pin_b = (uint16_t)(1U << (pin_number + 1U));
+  handle_ptr->port_a = &port;
+  handle_ptr->port_b = &port;
+  if (handle_ptr->count_mode == ROT_ENC_SATURATE)
+  {
+    handle_ptr->count_mode = ROT_ENC_UNBOUNDED;
+  }
+  CHECK(init_rotary_encoder(handle_ptr));
+}
+
+
+/**
+ * Checks one drained event.
+ * @param takes a pointer to the event.
+ * @param takes the expected encoder id.
+ * @param takes the expected delta.
+ * @param takes the expected timestamp.
+ */
+static void check_event(const rot_enc_event_t *event_ptr,
+                        uint8_t encoder_id,
+                        int32_t delta,
+                        uint32_t timestamp)
+{
+  CHECK_EQ(event_ptr->encoder_id, encoder_id);
+  CHECK_EQ(event_ptr->delta, delta);
+  CHECK_EQ(event_ptr->timestamp, timestamp);
+}
+
+
+/**
+ * Each count queues its encoder's id, the delta and the tick it happened
+ * on, oldest first.
+ */
+static void check_ids_and_timestamps(void)
+{
+  rot_enc_handle_t first = {0};
+  rot_enc_handle_t second = {0};
+  int32_t first_position = 0;
+  int32_t second_position = 0;
+
+  test_reset_driver();
+  port.IDR = 0;
+  setup(&first, 0);
+  setup(&second, 4);
+
+  test_turn(&first, &first_position, 2, 10);
+  test_turn(&second, &second_position, -1, 5);
+  test_turn(&first, &first_position, -1, 1);
+
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 4);
+  check_event(&events[0], first.id, 1, 10);
+  check_event(&events[1], first.id, 1, 20);
+  check_event(&events[2], second.id, -1, 25);
+  check_event(&events[3], first.id, -1, 26);
+  CHECK(first.id != second.id);
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 0);
+  CHECK_EQ(rot_enc_get_dropped_event_count(), 0);
+}
+
+
+/**
+ * A full queue keeps its oldest events and counts the rest as dropped, and
+ * takes new events again once drained.
+ */
+static void check_full_queue(void)
+{
+  rot_enc_handle_t encoder = {0};
+  int32_t position = 0;
+
+  test_reset_driver();
+  port.IDR = 0;
+  setup(&encoder, 0);
+
+  test_turn(&encoder, &position, QUEUE_CAPACITY + 3, 1);
+  CHECK_EQ(rot_enc_get_dropped_event_count(), 3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), QUEUE_CAPACITY + 3);
+
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE),
+           QUEUE_CAPACITY);
+  check_event(&events[0], encoder.id, 1, 1);
+  check_event(&events[QUEUE_CAPACITY - 1], encoder.id, 1, QUEUE_CAPACITY);
+
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 1);
+  check_event(&events[0], encoder.id, -1, QUEUE_CAPACITY + 4);
+  CHECK_EQ(rot_enc_get_dropped_event_count(), 3);
+}
+
+
+/**
+ * A drain smaller than the queue leaves the newer events queued, in order,
+ * including across the end of the buffer.
+ */
+static void check_partial_drain(void)
+{
+  rot_enc_handle_t encoder = {0};
+  int32_t position = 0;
+
+  test_reset_driver();
+  port.IDR = 0;
+  setup(&encoder, 0);
+
+  test_turn(&encoder, &position, 5, 1);
+  CHECK_EQ(rot_enc_drain_events(events, 2), 2);
+  check_event(&events[0], encoder.id, 1, 1);
+  check_event(&events[1], encoder.id, 1, 2);
+
+  // Run the head round past the end of the buffer.
+  test_turn(&encoder, &position, -4, 1);
+  CHECK_EQ(rot_enc_drain_events(events, 4), 4);
+  check_event(&events[0], encoder.id, 1, 3);
+  check_event(&events[2], encoder.id, 1, 5);
+  check_event(&events[3], encoder.id, -1, 6);
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 3);
+  check_event(&events[2], encoder.id, -1, 9);
+  CHECK_EQ(rot_enc_get_dropped_event_count(), 0);
+}
+
+
+/**
+ * A counter wrapping at its limits queues the step as turned, not the jump
+ * back across the range.
+ */
+static void check_wrap(void)
+{
+  rot_enc_handle_t encoder =
+  {
+    .count_mode = ROT_ENC_WRAP,
+    .counter_max = 9,
+    .counter_min = 0
+  };
+  int32_t position = 0;
+  int32_t total = 0;
+
+  test_reset_driver();
+  port.IDR = 0;
+  setup(&encoder, 0);
+
+  for (int pass = 0; pass < 4; ++pass)
+  {
+    test_turn(&encoder, &position, (pass < 2) ? 6 : -6, 1);
+    uint16_t count = rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE);
+    CHECK_EQ(count, 6);
+    for (uint16_t index = 0; index < count; ++index)
+    {
+      CHECK_EQ(events[index].delta, (pass < 2) ? 1 : -1);
+      total += events[index].delta;
+    }
+    CHECK_EQ(total, position);
+  }
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 0);
+}
+
+
+/**
+ * A button reset and an auto-zeroing index pulse queue the change they make
+ * to the counter.
+ */
+static void check_reset_and_index(void)
+{
+  rot_enc_handle_t encoder =
+  {
+    .button_pin = GPIO_PIN_3,
+    .index_pin = GPIO_PIN_2,
+    .index_port = &port,
+    .index_auto_zero = true,
+    .reset_value = 2
+  };
+  int32_t position = 0;
+
+  test_reset_driver();
+  port.IDR = 0;
+  setup(&encoder, 0);
+
+  test_turn(&encoder, &position, 5, 1);
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 5);
+
+  sim_tick = 100;
+  rot_enc_callback(GPIO_PIN_3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 2);
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 1);
+  check_event(&events[0], encoder.id, -3, 100);
+
+  test_turn(&encoder, &position, -3, 1);
+  sim_tick = 200;
+  port.IDR |= GPIO_PIN_2;
+  rot_enc_callback(GPIO_PIN_2);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 0);
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 4);
+  check_event(&events[2], encoder.id, -1, 103);
+  check_event(&events[3], encoder.id, 1, 200);
+}
+
+
+/**
+ * A timer backed encoder queues one event for all the counts found at each
+ * read of the timer.
+ */
+static void check_timer_sync(void)
+{
+  rot_enc_handle_t encoder =
+  {
+    .timer = &timer,
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+
+  test_reset_driver();
+  timer.ARR = 0xFFFFU;
+  timer.CNT = 0xFFFEU;
+  CHECK(init_rotary_encoder(&encoder));
+
+  sim_tick = 10;
+  timer.CNT = 6U;
+  rot_enc_tick();
+  sim_tick = 11;
+  rot_enc_tick();
+  sim_tick = 12;
+  timer.CNT = 0xFFFDU;
+  rot_enc_tick();
+
+  CHECK_EQ(rot_enc_drain_events(events, ROT_ENC_EVENT_QUEUE_SIZE), 2);
+  check_event(&events[0], encoder.id, 8, 10);
+  check_event(&events[1], encoder.id, -9, 12);
+}
+
+
+int main(void)
+{
+  check_ids_and_timestamps();
+  check_full_queue();
+  check_partial_drain();
+  check_wrap();
+  check_reset_and_index();
+  check_timer_sync();
+  return test_report("test_event_queue");
+}
+
+
+// End of file. //
@@ -0,0 +1,176 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_index.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Spins a simulated encoder with an index pulse once per revolution,
+ * and checks the latched position, the revolution count and auto-zero homing.
+ */
+
+#include "rot_enc_test.h"
+#include "sim_encoder.h"
+
+#define INDEX_PERIOD  400
+#define NUM_OF_EDGES  1210
+
+static GPIO_TypeDef port;
+static double edge_time[NUM_OF_EDGES];
+static int8_t edge_step[NUM_OF_EDGES];
+
+
+/**
+ * Spins an encoder with an index pin through NUM_OF_EDGES transitions.
+ * @param takes a pointer to a rot_enc_handle_t object, not yet initialised.
+ * @param takes the direction, -1 or 1.
+ */
+static void run_spin(rot_enc_handle_t *encoder_ptr, int8_t step)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  encoder_ptr->pin_a = GPIO_PIN_0;
+  encoder_ptr->pin_b = GPIO_PIN_1;
+  encoder_ptr->port_a = &port;
+  encoder_ptr->port_b = &port;
+  encoder_ptr->index_pin = GPIO_PIN_2;
+  encoder_ptr->index_port = &port;
+  CHECK(init_rotary_encoder(encoder_ptr));
+
+  // 10 us between edges, +/- 2 us.
+  sim_encoder_spin(edge_time, edge_step, NUM_OF_EDGES, step, 10000.0, 2000.0);
+
+  sim_encoder_t sim =
+  {
+    .handle_ptr = encoder_ptr,
+    .edge_time = edge_time,
+    .edge_step = edge_step,
+    .num_of_edges = NUM_OF_EDGES,
+    .read_ns = 20.0,
+    .latency_ns = 200.0,
+    .exit_ns = 100.0,
+    .index_period = INDEX_PERIOD
+  };
+  sim_encoder_run(&sim);
+}
+
+
+/**
+ * Without auto-zero, the counter runs on and each index pulse latches it.
+ * @param takes the direction, -1 or 1.
+ */
+static void check_latch(int8_t step)
+{
+  rot_enc_handle_t encoder =
+  {
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  run_spin(&encoder, step);
+
+  CHECK(rot_enc_get_index_seen(&encoder));
+  CHECK_EQ(rot_enc_get_count_value(&encoder), step * NUM_OF_EDGES);
+  CHECK_EQ(rot_enc_get_index_position(&encoder), step * 3 * INDEX_PERIOD);
+  CHECK_EQ(rot_enc_get_revolutions(&encoder), step * 3);
+}
+
+
+/**
+ * With auto-zero, each index pulse latches one revolution and homes the
+ * counter.
+ */
+static void check_auto_zero(void)
+{
+  rot_enc_handle_t encoder =
+  {
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .index_auto_zero = true
+  };
+  run_spin(&encoder, 1);
+
+  CHECK_EQ(rot_enc_get_index_position(&encoder), INDEX_PERIOD);
+  CHECK_EQ(rot_enc_get_revolutions(&encoder), 3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), NUM_OF_EDGES - 3 * INDEX_PERIOD);
+}
+
+
+/**
+ * With a range that excludes 0, auto-zero homes to the nearest limit.
+ */
+static void check_auto_zero_clamped(void)
+{
+  rot_enc_handle_t encoder =
+  {
+    .counter_min = 100,
+    .counter_max = 1000,
+    .index_auto_zero = true
+  };
+  run_spin(&encoder, 1);
+
+  // Each revolution runs on from the home position at counter_min.
+  CHECK_EQ(rot_enc_get_index_position(&encoder), 100 + INDEX_PERIOD);
+  CHECK_EQ(rot_enc_get_revolutions(&encoder), 3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder),
+           100 + NUM_OF_EDGES - 3 * INDEX_PERIOD);
+}
+
+
+/**
+ * No index pulse is seen before the first revolution.
+ */
+static void check_not_seen(void)
+{
+  rot_enc_handle_t encoder =
+  {
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  test_reset_driver();
+  port.IDR = 0;
+  encoder.pin_a = GPIO_PIN_0;
+  encoder.pin_b = GPIO_PIN_1;
+  encoder.port_a = &port;
+  encoder.port_b = &port;
+  encoder.index_pin = GPIO_PIN_2;
+  encoder.index_port = &port;
+  CHECK(init_rotary_encoder(&encoder));
+
+  int32_t position = 0;
+  test_turn(&encoder, &position, INDEX_PERIOD - 1, 10);
+  CHECK(!rot_enc_get_index_seen(&encoder));
+  CHECK_EQ(rot_enc_get_revolutions(&encoder), 0);
+}
+
+
+int main(void)
+{
+  check_latch(1);
+  check_latch(-1);
+  check_auto_zero();
+  check_auto_zero_clamped();
+  check_not_seen();
+  return test_report("test_index");
+}
+
+
+// End of file. //
@@ -0,0 +1,167 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+/**
+ * @file test_map.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks output mapping by lookup table and by piecewise-linear
+ * segments: clamping outside the mapped range, interpolation and its
+ * rounding, decreasing curves, and a lookup table with no spacing.
+ */
+
+#include "rot_enc_test.h"
+
+static rot_enc_handle_t encoder;
+
+
+/**
+ * @param takes the map, or NULL for none.
+ * @param takes the counter value.
+ * @return the mapped value.
+ */
+static int32_t mapped(const rot_enc_map_t *map_ptr, rot_enc_count_t count)
+{
+  encoder.map = map_ptr;
+  encoder.counter = count;
+  return rot_enc_get_mapped_value(&encoder);
+}
+
+
+static void test_lookup_table(void)
+{
+  static const int32_t outputs[] = {0, 10, 40, 100};
+  static const rot_enc_map_t map =
+  {
+    .outputs = outputs,
+    .num_of_points = 4,
+    .input_min = 10,
+    .input_step = 5
+  };
+
+  CHECK_EQ(mapped(NULL, -3), -3);
+
+  // Held at the first and last outputs outside the range.
+  CHECK_EQ(mapped(&map, -1000), 0);
+  CHECK_EQ(mapped(&map, 9), 0);
+  CHECK_EQ(mapped(&map, 25), 100);
+  CHECK_EQ(mapped(&map, 1000), 100);
+
+  // Exact at each point, interpolated between them.
+  CHECK_EQ(mapped(&map, 10), 0);
+  CHECK_EQ(mapped(&map, 12), 4);
+  CHECK_EQ(mapped(&map, 15), 10);
+  CHECK_EQ(mapped(&map, 17), 22);
+  CHECK_EQ(mapped(&map, 20), 40);
+  CHECK_EQ(mapped(&map, 24), 88);
+}
+
+
+static void test_piecewise(void)
+{
+  static const rot_enc_count_t inputs[] = {-100, 0, 50};
+  static const int32_t outputs[] = {0, 1000, 1100};
+  static const rot_enc_map_t map =
+  {
+    .outputs = outputs,
+    .num_of_points = 3,
+    .inputs = inputs
+  };
+
+  CHECK_EQ(mapped(&map, -150), 0);
+  CHECK_EQ(mapped(&map, -100), 0);
+  CHECK_EQ(mapped(&map, -50), 500);
+  CHECK_EQ(mapped(&map, 0), 1000);
+  CHECK_EQ(mapped(&map, 25), 1050);
+  CHECK_EQ(mapped(&map, 49), 1098);
+  CHECK_EQ(mapped(&map, 50), 1100);
+  CHECK_EQ(mapped(&map, 60), 1100);
+}
+
+
+/**
+ * A decreasing curve clamps to its own first and last outputs, and rounds
+ * towards the earlier point, mirroring the same curve increasing.
+ */
+static void test_decreasing(void)
+{
+  static const int32_t down_outputs[] = {100, 0, -50};
+  static const int32_t up_outputs[] = {-100, 0, 50};
+  static const rot_enc_map_t down =
+  {
+    .outputs = down_outputs,
+    .num_of_points = 3,
+    .input_min = 0,
+    .input_step = 3
+  };
+  static const rot_enc_map_t up =
+  {
+    .outputs = up_outputs,
+    .num_of_points = 3,
+    .input_min = 0,
+    .input_step = 3
+  };
+
+  CHECK_EQ(mapped(&down, -1), 100);
+  CHECK_EQ(mapped(&down, 7), -50);
+  CHECK_EQ(mapped(&down, 3), 0);
+  for (rot_enc_count_t count = -1; count <= 7; ++count)
+  {
+    CHECK_EQ(mapped(&down, count), -mapped(&up, count));
+  }
+  CHECK_EQ(mapped(&down, 1), 67);
+  CHECK_EQ(mapped(&down, 4), -16);
+}
+
+
+/**
+ * A lookup table with no spacing steps from the first output to the last at
+ * input_min, rather than dividing by zero.
+ */
+static void test_zero_step(void)
+{
+  static const int32_t outputs[] = {5, 20, 50};
+  static const rot_enc_map_t map =
+  {
+    .outputs = outputs,
+    .num_of_points = 3,
+    .input_min = 20,
+    .input_step = 0
+  };
+
+  CHECK_EQ(mapped(&map, 19), 5);
+  CHECK_EQ(mapped(&map, 20), 5);
+  CHECK_EQ(mapped(&map, 21), 50);
+}
+
+
+int main(void)
+{
+  test_lookup_table();
+  test_piecewise();
+  test_decreasing();
+  test_zero_step();
+  return test_report("test_map");
+}
+
+
+// End of file. //
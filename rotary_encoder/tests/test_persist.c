@@ -0,0 +1,245 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_persist.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks counter persistence against a file backed flash simulation:
+ * debounced writes and the write rate under continuous turning, and restore
+ * after a simulated reboot. Also checks every slot of the backup register
+ * store.
+ */
+
+#define MAX_NUM_OF_ENCODERS   20
+
+#include "rot_enc_test.h"
+#include "sim_flash_store.h"
+#include "rotary_encoder_backup_store.c"
+
+// The Makefile puts the flash file in its build directory.
+#ifndef TEST_FLASH_PATH
+#define TEST_FLASH_PATH       "test_persist_flash.bin"
+#endif
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static int32_t position;
+
+
+/**
+ * Powers up, restoring the encoder from the flash file.
+ * @param takes true to erase the flash first, as for a new device.
+ * @param takes the counter limits.
+ * @return false if the flash file could not be opened.
+ */
+static bool boot(bool erase, rot_enc_count_t counter_min,
+                 rot_enc_count_t counter_max)
+{
+  test_reset_driver();
+  bool opened = sim_flash_open(TEST_FLASH_PATH, erase);
+  CHECK(opened);
+  if (!opened)
+  {
+    return false;
+  }
+  port.IDR = 0;
+  position = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .counter_min = counter_min,
+    .counter_max = counter_max,
+    .persist = true
+  };
+  encoder = fresh;
+  rot_enc_set_store(&sim_flash_store);
+  CHECK(init_rotary_encoder(&encoder));
+  return true;
+}
+
+
+/**
+ * Runs the main loop once a millisecond, turning the encoder one transition
+ * every interval ms while turning.
+ * @param takes the time to run for in ms.
+ * @param takes the direction, -1, 0 to stay still, or 1.
+ * @param takes the ms between transitions.
+ */
+static void run(uint32_t duration, int8_t step, uint32_t interval)
+{
+  for (uint32_t elapsed = 1; elapsed <= duration; ++elapsed)
+  {
+    ++sim_tick;
+    if (step != 0 && (elapsed % interval) == 0)
+    {
+      test_turn(&encoder, &position, step, 0);
+    }
+    rot_enc_save_positions();
+  }
+}
+
+
+/**
+ * Turning continuously writes nothing until the encoder stops.
+ */
+static void test_continuous_turning(void)
+{
+  if (!boot(true, 0, 10000))
+  {
+    return;
+  }
+
+  // 10 s at 200 transitions per second.
+  run(10000, 1, 5);
+  CHECK_EQ(sim_flash_writes[0], 0);
+
+  run(ROT_ENC_PERSIST_DELAY_MS, 0, 1);
+  CHECK_EQ(sim_flash_writes[0], 1);
+  printf("continuous turning: %d changes in 10 s, %u flash writes\n",
+         (int)encoder.counter, (unsigned)sim_flash_writes[0]);
+
+  // Holding still writes nothing more.
+  run(10000, 0, 1);
+  CHECK_EQ(sim_flash_writes[0], 1);
+}
+
+
+/**
+ * Turning in bursts writes once per pause, and a value turned back to
+ * before the write is due is not written again.
+ */
+static void test_bursts(void)
+{
+  if (!boot(true, 0, 10000))
+  {
+    return;
+  }
+
+  uint32_t changes = 0;
+  for (uint32_t burst = 0; burst < 10; ++burst)
+  {
+    run(500, 1, 2);
+    changes += 250;
+    run(2000, 0, 1);
+  }
+  CHECK_EQ(encoder.counter, changes);
+  CHECK_EQ(sim_flash_writes[0], 10);
+  printf("bursts: %u changes in 25 s, %u flash writes, "
+         "%.2f writes per second\n",
+         (unsigned)changes, (unsigned)sim_flash_writes[0],
+         sim_flash_writes[0] / 25.0);
+
+  run(100, 1, 10);
+  run(100, -1, 10);
+  run(ROT_ENC_PERSIST_DELAY_MS * 2, 0, 1);
+  CHECK_EQ(sim_flash_writes[0], 10);
+}
+
+
+/**
+ * A reboot restores the last written value, confined to the limits.
+ */
+static void test_restore(void)
+{
+  if (!boot(true, 0, 10000))
+  {
+    return;
+  }
+  run(1000, 1, 2);
+  run(ROT_ENC_PERSIST_DELAY_MS, 0, 1);
+  CHECK_EQ(encoder.counter, 500);
+
+  // Turned again, but the power failed before the write was due.
+  run(100, 1, 2);
+  sim_flash_close();
+
+  if (!boot(false, 0, 10000))
+  {
+    return;
+  }
+  CHECK_EQ(encoder.counter, 500);
+
+  if (!boot(false, 0, 200))
+  {
+    return;
+  }
+  CHECK_EQ(encoder.counter, 200);
+
+  // A new device has nothing to restore.
+  if (!boot(true, 0, 10000))
+  {
+    return;
+  }
+  CHECK_EQ(encoder.counter, 0);
+  sim_flash_close();
+  remove(TEST_FLASH_PATH);
+}
+
+
+/**
+ * Every slot of the backup register store, with 20 encoders configured.
+ * Slots past the last valid bit must not disturb the others.
+ */
+static void test_backup_store(void)
+{
+  memset(&sim_rtc, 0, sizeof(sim_rtc));
+
+  rot_enc_count_t value;
+  CHECK(!rot_enc_backup_store.read(0, &value));
+
+  for (uint8_t slot = 0; slot < MAX_NUM_OF_ENCODERS; ++slot)
+  {
+    rot_enc_backup_store.write(slot, (rot_enc_count_t)(1000 + slot));
+  }
+
+  for (uint8_t slot = 0; slot < MAX_NUM_OF_ENCODERS; ++slot)
+  {
+    value = 0;
+    bool stored = rot_enc_backup_store.read(slot, &value);
+    CHECK_EQ(stored, slot < MAX_NUM_OF_SLOTS);
+    CHECK_EQ(value, stored ? 1000 + slot : 0);
+  }
+
+  // A backup domain reset clears the marker, so nothing is restored.
+  memset(&sim_rtc, 0, sizeof(sim_rtc));
+  CHECK(!rot_enc_backup_store.read(0, &value));
+}
+
+
+int main(void)
+{
+  test_continuous_turning();
+  test_bursts();
+  test_restore();
+  test_backup_store();
+  return test_report("test_persist");
+}
+
+
+// End of file. //
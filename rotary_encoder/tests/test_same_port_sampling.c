@@ -0,0 +1,115 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_same_port_sampling.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Simulates a fast spin with edges landing while the ISR reads the
+ * pins, and checks that sampling A and B with one IDR read gives fewer
+ * spurious zero lookups (bounces and double transitions) than reading them
+ * separately.
+ */
+
+#include "rot_enc_test.h"
+#include "sim_encoder.h"
+
+#define NUM_OF_EDGES  20000
+
+static GPIO_TypeDef port_a;
+static GPIO_TypeDef port_b;
+static double edge_time[NUM_OF_EDGES];
+static int8_t edge_step[NUM_OF_EDGES];
+
+
+/**
+ * Runs the spin through an encoder wired as given.
+ * @param takes the port of pin B, port_a for a same port encoder.
+ * @param takes a pointer to a rot_enc_stats_t object to copy the stats into.
+ * @return the final position.
+ */
+static int32_t run_spin(GPIO_TypeDef *port_b_ptr, rot_enc_stats_t *stats_ptr)
+{
+  test_reset_driver();
+  port_a.IDR = 0;
+  port_b.IDR = 0;
+
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port_a,
+    .port_b = port_b_ptr,
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  CHECK(init_rotary_encoder(&encoder));
+
+  // 2 us between edges, with edges up to 1.6 us early or late, and 150 ns
+  // per HAL pin read.
+  sim_encoder_t sim =
+  {
+    .handle_ptr = &encoder,
+    .edge_time = edge_time,
+    .edge_step = edge_step,
+    .num_of_edges = NUM_OF_EDGES,
+    .read_ns = 150.0,
+    .latency_ns = 200.0,
+    .exit_ns = 100.0
+  };
+  sim_encoder_run(&sim);
+
+  rot_enc_get_stats(&encoder, stats_ptr, false);
+  return encoder.position;
+}
+
+
+int main(void)
+{
+  sim_encoder_spin(edge_time, edge_step, NUM_OF_EDGES, 1, 2000.0, 1600.0);
+
+  rot_enc_stats_t split_stats;
+  rot_enc_stats_t same_stats;
+  int32_t split_position = run_spin(&port_b, &split_stats);
+  int32_t same_position = run_spin(&port_a, &same_stats);
+
+  uint32_t split_zero = split_stats.bounces + split_stats.invalid_transitions;
+  uint32_t same_zero = same_stats.bounces + same_stats.invalid_transitions;
+
+  printf("separate reads: position %d of %d, %u bounces, %u double\n",
+         (int)split_position, NUM_OF_EDGES, (unsigned)split_stats.bounces,
+         (unsigned)split_stats.invalid_transitions);
+  printf("single read:    position %d of %d, %u bounces, %u double\n",
+         (int)same_position, NUM_OF_EDGES, (unsigned)same_stats.bounces,
+         (unsigned)same_stats.invalid_transitions);
+
+  CHECK(split_zero > 0);
+  CHECK(same_zero < split_zero);
+  CHECK(abs(NUM_OF_EDGES - same_position) <=
+        abs(NUM_OF_EDGES - split_position));
+
+  return test_report("test_same_port_sampling");
+}
+
+
+// End of file. //
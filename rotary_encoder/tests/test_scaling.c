@@ -0,0 +1,165 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_scaling.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks count scaling by step_multiplier / step_divisor: that a unit
+ * takes the same travel in either direction, and that jitter of one
+ * transition at rest does not flicker the counter.
+ */
+
+#include "rot_enc_test.h"
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static int32_t position;
+
+
+/**
+ * Initialises an unbounded encoder at position 0 with a scaling.
+ * @param takes the step multiplier.
+ * @param takes the step divisor.
+ */
+static void setup(int16_t step_multiplier, uint16_t step_divisor)
+{
+  test_reset_driver();
+  port.IDR = 0;
+  position = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .step_multiplier = step_multiplier,
+    .step_divisor = step_divisor
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+}
+
+
+/**
+ * Bounces one transition either way, checking the counter never moves.
+ * @param takes the number of bounces.
+ */
+static void check_jitter(int32_t bounces)
+{
+  rot_enc_count_t rest = encoder.counter;
+
+  rot_enc_process_changes();
+  for (int32_t bounce = 0; bounce < bounces; ++bounce)
+  {
+    test_turn(&encoder, &position, 1, 1);
+    CHECK_EQ(encoder.counter, rest);
+    test_turn(&encoder, &position, -1, 1);
+    CHECK_EQ(encoder.counter, rest);
+    test_turn(&encoder, &position, -1, 1);
+    CHECK_EQ(encoder.counter, rest);
+    test_turn(&encoder, &position, 1, 1);
+    CHECK_EQ(encoder.counter, rest);
+  }
+  CHECK_EQ(rot_enc_get_dirty_mask(), 0);
+}
+
+
+/**
+ * One unit every 4 transitions, as for one count per quadrature cycle.
+ */
+static void test_quarter(void)
+{
+  setup(1, 4);
+  check_jitter(50);
+
+  // Each direction takes 4 transitions from rest.
+  test_turn(&encoder, &position, 3, 1);
+  CHECK_EQ(encoder.counter, 0);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 1);
+  check_jitter(50);
+
+  setup(1, 4);
+  test_turn(&encoder, &position, -3, 1);
+  CHECK_EQ(encoder.counter, 0);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, -1);
+  check_jitter(50);
+
+  // Turning back takes a full 4 transitions to undo a unit.
+  test_turn(&encoder, &position, 3, 1);
+  CHECK_EQ(encoder.counter, -1);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 0);
+
+  // A long spin each way lands back where it started.
+  test_turn(&encoder, &position, 4001, 1);
+  CHECK_EQ(encoder.counter, 1000);
+  test_turn(&encoder, &position, -4001, 1);
+  CHECK_EQ(encoder.counter, 0);
+}
+
+
+/**
+ * Whole and fractional multipliers.
+ */
+static void test_multipliers(void)
+{
+  setup(10, 1);
+  test_turn(&encoder, &position, 3, 1);
+  CHECK_EQ(encoder.counter, 30);
+  test_turn(&encoder, &position, -5, 1);
+  CHECK_EQ(encoder.counter, -20);
+
+  // 3 / 2 gives 1, 3, 4, 6 ... in both directions.
+  setup(3, 2);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 1);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 3);
+  test_turn(&encoder, &position, 1, 1);
+  CHECK_EQ(encoder.counter, 4);
+
+  setup(3, 2);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, -1);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, -3);
+  test_turn(&encoder, &position, -1, 1);
+  CHECK_EQ(encoder.counter, -4);
+}
+
+
+int main(void)
+{
+  test_quarter();
+  test_multipliers();
+  return test_report("test_scaling");
+}
+
+
+// End of file. //
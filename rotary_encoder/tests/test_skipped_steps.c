@@ -0,0 +1,122 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_skipped_steps.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Injects interrupt latency into a simulated spin, so some ISRs run
+ * after two edges, and checks the count against the true position with and
+ * without skipped-step recovery.
+ */
+
+#include "rot_enc_test.h"
+#include "sim_encoder.h"
+
+#define NUM_OF_EDGES  10000
+
+static GPIO_TypeDef port;
+static double edge_time[NUM_OF_EDGES];
+static int8_t edge_step[NUM_OF_EDGES];
+
+
+/**
+ * Runs the spin with 1 in 20 ISRs delayed by 1.2 edge intervals.
+ * @param takes true to enable skipped-step recovery.
+ * @param takes a pointer to a rot_enc_stats_t object to copy the stats into.
+ * @return the final counter value.
+ */
+static int32_t run_spin(bool recover, rot_enc_stats_t *stats_ptr)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .recover_skipped_steps = recover
+  };
+  CHECK(init_rotary_encoder(&encoder));
+
+  sim_encoder_t sim =
+  {
+    .handle_ptr = &encoder,
+    .edge_time = edge_time,
+    .edge_step = edge_step,
+    .num_of_edges = NUM_OF_EDGES,
+    .read_ns = 20.0,
+    .latency_ns = 200.0,
+    .exit_ns = 100.0,
+    .stall_ns = 12000.0,
+    .stall_per_thousand = 50
+  };
+  sim_encoder_run(&sim);
+
+  rot_enc_get_stats(&encoder, stats_ptr, false);
+  return encoder.counter;
+}
+
+
+/**
+ * Spins in one direction, and checks the counts.
+ * @param takes the direction, -1 or 1.
+ */
+static void check_direction(int8_t step)
+{
+  int32_t truth = step * NUM_OF_EDGES;
+
+  // 10 us between edges, +/- 1 us.
+  sim_encoder_spin(edge_time, edge_step, NUM_OF_EDGES, step, 10000.0, 1000.0);
+
+  rot_enc_stats_t plain_stats;
+  rot_enc_stats_t recovered_stats;
+  int32_t plain = run_spin(false, &plain_stats);
+  int32_t recovered = run_spin(true, &recovered_stats);
+
+  printf("direction %+d: truth %d, without recovery %d (%u missed), "
+         "with recovery %d (%u missed)\n",
+         step, (int)truth, (int)plain,
+         (unsigned)plain_stats.invalid_transitions, (int)recovered,
+         (unsigned)recovered_stats.invalid_transitions);
+
+  // Every missed step loses two transitions without recovery.
+  CHECK(plain_stats.invalid_transitions > 0);
+  CHECK_EQ(plain, truth - step * 2 * (int32_t)plain_stats.invalid_transitions);
+  CHECK_EQ(recovered, truth);
+}
+
+
+int main(void)
+{
+  check_direction(1);
+  check_direction(-1);
+  return test_report("test_skipped_steps");
+}
+
+
+// End of file. //
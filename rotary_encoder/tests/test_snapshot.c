@@ -0,0 +1,138 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+/**
+ * @file test_snapshot.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks that rot_enc_snapshot() writes only the counts selected by
+ * its mask, each at its encoder's id, and brings timer backed counts up to
+ * date.
+ */
+
+#include "rot_enc_test.h"
+
+#define NUM_OF_EXTI_ENCODERS  3
+#define UNWRITTEN             -1234
+
+static GPIO_TypeDef port;
+static TIM_TypeDef timer;
+static rot_enc_handle_t encoders[NUM_OF_EXTI_ENCODERS];
+static rot_enc_handle_t timer_encoder;
+static rot_enc_count_t counts[MAX_NUM_OF_ENCODERS];
+
+
+/**
+ * Registers three EXTI driven encoders, then a timer backed one, and turns
+ * each by a different amount.
+ */
+static void setup(void)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  for (uint8_t index = 0; index < NUM_OF_EXTI_ENCODERS; ++index)
+  {
+    rot_enc_handle_t fresh =
+    {
+      .pin_a = (uint16_t)(GPIO_PIN_0 << (2U * index)),
+      .pin_b = (uint16_t)(GPIO_PIN_1 << (2U * index)),
+      .port_a = &port,
+      .port_b = &port,
+      .count_mode = ROT_ENC_UNBOUNDED
+    };
+    encoders[index] = fresh;
+    CHECK(init_rotary_encoder(&encoders[index]));
+    CHECK_EQ(encoders[index].id, index);
+
+    int32_t position = 0;
+    test_turn(&encoders[index], &position, 10 * (index + 1), 1);
+  }
+
+  timer.ARR = 0xFFFFU;
+  timer.CNT = 0;
+  rot_enc_handle_t fresh =
+  {
+    .timer = &timer,
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  timer_encoder = fresh;
+  CHECK(init_rotary_encoder(&timer_encoder));
+  CHECK_EQ(timer_encoder.id, NUM_OF_EXTI_ENCODERS);
+
+  for (uint8_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    counts[index] = UNWRITTEN;
+  }
+}
+
+
+/**
+ * Only the masked encoders are written, at their ids, and mask bits with no
+ * encoder registered are ignored.
+ */
+static void test_mask(void)
+{
+  setup();
+  sim_tick = 500;
+
+  uint32_t mask = (1UL << 0) | (1UL << 2) | (1UL << (MAX_NUM_OF_ENCODERS - 1));
+  CHECK_EQ(rot_enc_snapshot(counts, mask), 500);
+
+  CHECK_EQ(counts[0], 10);
+  CHECK_EQ(counts[1], UNWRITTEN);
+  CHECK_EQ(counts[2], 30);
+  for (uint8_t index = NUM_OF_EXTI_ENCODERS; index < MAX_NUM_OF_ENCODERS;
+       ++index)
+  {
+    CHECK_EQ(counts[index], UNWRITTEN);
+  }
+}
+
+
+/**
+ * A timer backed encoder is read from the timer, without waiting for
+ * rot_enc_tick().
+ */
+static void test_timer_sync(void)
+{
+  setup();
+  timer.CNT = 0xFFFFU - 6U;
+
+  rot_enc_snapshot(counts, 0xFFFFFFFFUL);
+  CHECK_EQ(counts[0], 10);
+  CHECK_EQ(counts[1], 20);
+  CHECK_EQ(counts[2], 30);
+  CHECK_EQ(counts[timer_encoder.id], -7);
+  CHECK_EQ(rot_enc_get_count_value(&timer_encoder), -7);
+}
+
+
+int main(void)
+{
+  test_mask();
+  test_timer_sync();
+  return test_report("test_snapshot");
+}
+
+
+// End of file. //
@@ -0,0 +1,111 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_static.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks the compile-time dispatch of rotary_encoder_static.h: counts
+ * on the generated cases, and button and index lines falling through to
+ * rot_enc_callback().
+ */
+
+#include "rot_enc_test.h"
+
+static GPIO_TypeDef port;
+
+#define ROT_ENC_STATIC_ENCODERS(X)  \
+  X(volume, &port, 0, &port, 1)     \
+  X(tuning, &port, 4, &port, 5)
+#include "rotary_encoder_static.h"
+
+
+/**
+ * Turns an encoder one interrupt per edge, through the static dispatch.
+ * @param takes a pointer to a rot_enc_handle_t object.
+ * @param takes a pointer to the encoder's position, updated on return.
+ * @param takes the number of transitions, negative when decrementing.
+ */
+static void turn_static(rot_enc_handle_t *handle_ptr,
+                        int32_t *position_ptr,
+                        int32_t transitions)
+{
+  int32_t step = (transitions < 0) ? -1 : 1;
+
+  for (int32_t done = 0; done != transitions; done += step)
+  {
+    uint8_t old_state = test_quadrature_state(*position_ptr);
+    *position_ptr += step;
+    uint8_t new_state = test_quadrature_state(*position_ptr);
+
+    ++sim_tick;
+    test_set_pins(handle_ptr, new_state);
+    rot_enc_static_callback(((old_state ^ new_state) & 0x2U) ?
+                            handle_ptr->pin_a : handle_ptr->pin_b);
+  }
+}
+
+
+int main(void)
+{
+  int32_t volume_position = 0;
+  int32_t tuning_position = 0;
+
+  test_reset_driver();
+  port.IDR = 0;
+  rot_enc_volume.count_mode = ROT_ENC_UNBOUNDED;
+  rot_enc_volume.button_pin = GPIO_PIN_2;
+  rot_enc_tuning.count_mode = ROT_ENC_UNBOUNDED;
+  rot_enc_tuning.index_pin = GPIO_PIN_6;
+  rot_enc_tuning.index_port = &port;
+  CHECK(rot_enc_static_init());
+
+  turn_static(&rot_enc_volume, &volume_position, 10);
+  turn_static(&rot_enc_tuning, &tuning_position, -7);
+  CHECK_EQ(rot_enc_volume.counter, 10);
+  CHECK_EQ(rot_enc_tuning.counter, -7);
+
+  // The button line is not a generated case, so it resets through
+  // rot_enc_callback().
+  rot_enc_static_callback(GPIO_PIN_2);
+  CHECK_EQ(rot_enc_volume.counter, 0);
+  CHECK_EQ(rot_enc_tuning.counter, -7);
+
+  // So is the index line.
+  port.IDR |= GPIO_PIN_6;
+  rot_enc_static_callback(GPIO_PIN_6);
+  port.IDR &= ~GPIO_PIN_6;
+  CHECK(rot_enc_get_index_seen(&rot_enc_tuning));
+  CHECK_EQ(rot_enc_get_index_position(&rot_enc_tuning), -7);
+
+  // Lines that belong to no encoder are ignored.
+  rot_enc_static_callback(GPIO_PIN_12);
+  CHECK_EQ(rot_enc_volume.counter, 0);
+  CHECK_EQ(rot_enc_tuning.counter, -7);
+
+  return test_report("test_static");
+}
+
+
+// End of file. //
@@ -0,0 +1,175 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_storm.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Simulates a chattering encoder line, and compares the interrupt
+ * load with and without storm protection. Also checks that the encoder
+ * counts normally once the line settles and interrupts are re-enabled.
+ */
+
+#include "rot_enc_test.h"
+
+// Chatter on pin B every 5 to 15 us, 10 us on average, for 200 ms.
+#define CHATTER_PERIOD_US   10
+#define CHATTER_US          200000
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static uint32_t isr_calls;
+static uint32_t polls;
+
+
+/**
+ * Advances the simulation by 1 us, running rot_enc_tick() on each ms.
+ */
+static void step_us(uint32_t *time_us_ptr)
+{
+  ++*time_us_ptr;
+  if (*time_us_ptr % 1000U == 0)
+  {
+    ++sim_tick;
+    polls += encoder.storm_active;
+    rot_enc_tick();
+  }
+}
+
+
+/**
+ * Changes pins on the port, and runs the ISR if their EXTI line is enabled.
+ * @param takes the pins to toggle.
+ */
+static void toggle(uint16_t pins)
+{
+  port.IDR ^= pins;
+  if (sim_exti.IMR & pins)
+  {
+    ++isr_calls;
+    rot_enc_callback(pins);
+  }
+  else
+  {
+    sim_exti.PR |= pins;
+  }
+}
+
+
+/**
+ * Runs the chatter, then turns the encoder 20 steps once it has settled.
+ * @param takes the storm threshold, 0 to disable protection.
+ */
+static void run(uint16_t storm_threshold)
+{
+  test_reset_driver();
+  port.IDR = 0;
+  isr_calls = 0;
+  polls = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .storm_threshold = storm_threshold
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+
+  uint32_t time_us = 0;
+  uint32_t next_edge_us = 0;
+  uint32_t chatter_edges = 0;
+  while (time_us < CHATTER_US)
+  {
+    if (time_us == next_edge_us)
+    {
+      toggle(GPIO_PIN_1);
+      ++chatter_edges;
+      next_edge_us += CHATTER_PERIOD_US - 5U + test_random() % 11U;
+    }
+    step_us(&time_us);
+  }
+
+  // Settled, with B back where it started.
+  if (port.IDR & GPIO_PIN_1)
+  {
+    toggle(GPIO_PIN_1);
+  }
+  uint32_t chatter_isr_calls = isr_calls;
+  uint32_t chatter_polls = polls;
+  for (uint32_t us = 0; us < 100000; ++us)
+  {
+    step_us(&time_us);
+  }
+  CHECK(!encoder.storm_active);
+  CHECK_EQ(sim_exti.IMR & (GPIO_PIN_0 | GPIO_PIN_1), GPIO_PIN_0 | GPIO_PIN_1);
+
+  printf("storm threshold %u: %u ISR calls and %u storm polls for %u "
+         "edges\n", (unsigned)storm_threshold, (unsigned)chatter_isr_calls,
+         (unsigned)chatter_polls, (unsigned)chatter_edges);
+
+  // Turn 20 steps, one every 5 ms, through the ISR.
+  rot_enc_count_t start = encoder.counter;
+  int32_t position = 0;
+  for (int step = 0; step < 20; ++step)
+  {
+    uint8_t old_state = test_quadrature_state(position++);
+    uint8_t new_state = test_quadrature_state(position);
+    toggle((uint16_t)((((old_state ^ new_state) >> 1) & 1U) ? GPIO_PIN_0 :
+                                                              GPIO_PIN_1));
+    for (uint32_t us = 0; us < 5000; ++us)
+    {
+      step_us(&time_us);
+    }
+  }
+  CHECK_EQ(encoder.counter - start, 20);
+  CHECK(!encoder.storm_active);
+
+  if (storm_threshold == 0)
+  {
+    CHECK_EQ(chatter_isr_calls, chatter_edges);
+    CHECK_EQ(encoder.stats.storms, 0);
+  }
+  else
+  {
+    // Masked after storm_threshold edges, then polled once a ms.
+    CHECK(chatter_isr_calls <= storm_threshold + 1U);
+    CHECK(chatter_polls <= CHATTER_US / 1000U + 1U);
+    CHECK_EQ(encoder.stats.storms, 1);
+  }
+}
+
+
+int main(void)
+{
+  run(0);
+  run(20);
+  return test_report("test_storm");
+}
+
+
+// End of file. //
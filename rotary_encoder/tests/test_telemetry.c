@@ -0,0 +1,159 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_telemetry.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Decodes telemetry frames captured from the simulated UART, and
+ * checks each record, including counters beyond 32 bits. Built once per
+ * counter width, with ROT_ENC_COUNTER_BITS set by the Makefile.
+ */
+
+#define MAX_NUM_OF_ENCODERS   10
+
+#include "rot_enc_test.h"
+
+#define RECORD_SIZE           (21 + ((ROT_ENC_COUNTER_BITS == 64) ? 8 : 4))
+
+static GPIO_TypeDef port;
+static UART_HandleTypeDef uart;
+static rot_enc_handle_t encoders[MAX_NUM_OF_ENCODERS];
+
+
+/**
+ * @param takes a pointer to 4 little endian bytes.
+ * @return the value.
+ */
+static uint32_t read_u32(const uint8_t *bytes)
+{
+  return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+         ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+
+/**
+ * @param takes the encoder id.
+ * @return a counter value for the encoder, using the full counter width.
+ */
+static rot_enc_count_t expected_count(uint32_t id)
+{
+#if ROT_ENC_COUNTER_BITS == 64
+  return (id & 1U) ? -5000000000000LL - (int64_t)id : 7000000000LL + id;
+#elif ROT_ENC_COUNTER_BITS == 32
+  return (id & 1U) ? -2000000000L - (int32_t)id : 2000000000L + (int32_t)id;
+#else
+  return (id & 1U) ? -30000 - (int16_t)id : 30000 + (int16_t)id;
+#endif
+}
+
+
+int main(void)
+{
+  test_reset_driver();
+  init_log_system(&uart);
+  port.IDR = 0;
+
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    encoders[index].pin_a = (uint16_t)(GPIO_PIN_0 << (index % 8));
+    encoders[index].pin_b = (uint16_t)(GPIO_PIN_8 << (index % 8));
+    encoders[index].port_a = &port;
+    encoders[index].port_b = &port;
+    encoders[index].count_mode = ROT_ENC_UNBOUNDED;
+    CHECK(init_rotary_encoder(&encoders[index]));
+  }
+
+  // A few steps on one encoder, so its statistics are not all zero.
+  int32_t position = 0;
+  test_turn(&encoders[3], &position, 6, 1);
+
+  for (uint32_t index = 0; index < MAX_NUM_OF_ENCODERS; ++index)
+  {
+    encoders[index].counter = expected_count(encoders[index].id);
+  }
+
+  sim_uart_clear();
+  sim_tick += ROT_ENC_TELEMETRY_PERIOD_MS;
+  rot_enc_publish_telemetry();
+
+  // Frames of as many records as fit, then the rest.
+  uint32_t position_in_buffer = 0;
+  uint32_t num_of_frames = 0;
+  uint32_t num_of_records = 0;
+  while (position_in_buffer + 5 <= sim_uart_length)
+  {
+    const uint8_t *frame = &sim_uart_buffer[position_in_buffer];
+    uint16_t length = (uint16_t)(frame[3] | (frame[4] << 8));
+    CHECK_EQ(frame[0], 0xA5);
+    CHECK_EQ(frame[1], 0x5A);
+    CHECK_EQ(frame[2], ROT_ENC_TELEMETRY_FRAME_TYPE);
+
+    uint8_t checksum = frame[2] ^ frame[3] ^ frame[4];
+    for (uint16_t index = 0; index < length; ++index)
+    {
+      checksum ^= frame[5 + index];
+    }
+    CHECK_EQ(frame[5 + length], checksum);
+
+    const uint8_t *payload = &frame[5];
+    uint8_t records = payload[4];
+    CHECK_EQ(length, 5 + records * RECORD_SIZE);
+
+    for (uint8_t record = 0; record < records; ++record)
+    {
+      const uint8_t *fields = &payload[5 + record * RECORD_SIZE];
+      uint8_t id = fields[0];
+#if ROT_ENC_COUNTER_BITS == 64
+      int64_t count = (int64_t)((uint64_t)read_u32(&fields[1]) |
+                                ((uint64_t)read_u32(&fields[5]) << 32));
+      const uint8_t *stats = &fields[13];
+#else
+      int64_t count = (int32_t)read_u32(&fields[1]);
+      const uint8_t *stats = &fields[9];
+#endif
+      CHECK_EQ(id, num_of_records);
+      CHECK_EQ(count, expected_count(id));
+      CHECK_EQ(read_u32(stats), (id == 3) ? 6 : 0);
+      ++num_of_records;
+    }
+
+    position_in_buffer += 5 + length + 1;
+    ++num_of_frames;
+  }
+
+  CHECK_EQ(position_in_buffer, sim_uart_length);
+  CHECK_EQ(num_of_records, MAX_NUM_OF_ENCODERS);
+  uint32_t records_per_frame = (LOG_FRAME_MAX_PAYLOAD - 5) / RECORD_SIZE;
+  CHECK_EQ(num_of_frames, (MAX_NUM_OF_ENCODERS + records_per_frame - 1) /
+                          records_per_frame);
+
+  printf("%d bit counters: %u records in %u frames\n",
+         ROT_ENC_COUNTER_BITS, (unsigned)num_of_records,
+         (unsigned)num_of_frames);
+  return test_report("test_telemetry");
+}
+
+
+// End of file. //
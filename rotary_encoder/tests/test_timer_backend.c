@@ -0,0 +1,247 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_timer_backend.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Drives the timer backend with a register-level model of a timer in
+ * encoder mode, and checks the 32 bit extension of CNT as it wraps in both
+ * directions, on 16 and 32 bit timers, and counting as the extended position
+ * itself wraps.
+ */
+
+#include "rot_enc_test.h"
+
+static TIM_TypeDef timer;
+static rot_enc_handle_t encoder;
+
+
+/**
+ * Timer in encoder mode TI1 and TI2 (encoder mode 3), with A on TI1 and B
+ * on TI2. CNT counts every edge of either input, up or down by direction,
+ * and wraps between 0 and ARR. Edges where both inputs change at once are
+ * ignored, as the hardware's input filter would.
+ */
+typedef struct
+{
+    TIM_TypeDef *timer;
+    uint8_t state;
+}sim_timer_t;
+
+
+/**
+ * Applies new TI1/TI2 input levels to the model.
+ * @param takes a pointer to a sim_timer_t object.
+ * @param takes the new input state, TI1 << 1 | TI2.
+ */
+static void sim_timer_input(sim_timer_t *sim_ptr, uint8_t state)
+{
+  uint8_t changed = sim_ptr->state ^ state;
+  uint32_t cnt = sim_ptr->timer->CNT;
+  uint32_t arr = sim_ptr->timer->ARR;
+
+  if (changed == 0x2U || changed == 0x1U)
+  {
+    // Up if TI1 changed to differ from TI2, or TI2 changed to match TI1.
+    bool up = ((state >> 1) ^ state ^ (changed & 1U)) & 1U;
+    if (up)
+    {
+      cnt = (cnt == arr) ? 0 : cnt + 1U;
+    }
+    else
+    {
+      cnt = (cnt == 0) ? arr : cnt - 1U;
+    }
+  }
+  sim_ptr->timer->CNT = cnt;
+  sim_ptr->state = state;
+}
+
+
+/**
+ * Turns the encoder, running rot_enc_tick() every sync_every transitions.
+ * @param takes a pointer to a sim_timer_t object.
+ * @param takes a pointer to the encoder's position, updated on return.
+ * @param takes the number of transitions, negative when decrementing.
+ * @param takes the transitions between ticks.
+ */
+static void turn(sim_timer_t *sim_ptr,
+                 int32_t *position_ptr,
+                 int32_t transitions,
+                 int32_t sync_every)
+{
+  int32_t step = (transitions < 0) ? -1 : 1;
+
+  for (int32_t done = 0; done != transitions; done += step)
+  {
+    *position_ptr += step;
+    sim_timer_input(sim_ptr, test_quadrature_state(*position_ptr));
+    if ((done + step) % sync_every == 0)
+    {
+      ++sim_tick;
+      rot_enc_tick();
+    }
+  }
+  ++sim_tick;
+  rot_enc_tick();
+}
+
+
+/**
+ * Registers a fresh timer backed encoder.
+ * @param takes a pointer to a sim_timer_t object to set up.
+ * @param takes the timer's ARR.
+ * @param takes the timer's starting CNT.
+ * @param takes the resolution.
+ */
+static void setup(sim_timer_t *sim_ptr,
+                  uint32_t arr,
+                  uint32_t cnt,
+                  rot_enc_resolution_t resolution)
+{
+  test_reset_driver();
+  timer.ARR = arr;
+  timer.CNT = cnt;
+  sim_ptr->timer = &timer;
+  sim_ptr->state = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .timer = &timer,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .resolution = resolution
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+}
+
+
+/**
+ * Wraps CNT forwards, then backwards past where it started.
+ * @param takes the timer's ARR.
+ */
+static void check_wrap(uint32_t arr)
+{
+  sim_timer_t sim;
+  int32_t position = 0;
+
+  setup(&sim, arr, arr - 15U, ROT_ENC_RESOLUTION_4X);
+
+  turn(&sim, &position, 100, 10);
+  CHECK_EQ(timer.CNT, 84);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 100);
+  CHECK_EQ(encoder.position, 100);
+
+  turn(&sim, &position, -300, 10);
+  CHECK_EQ(timer.CNT, arr - 215U);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), -200);
+  CHECK_EQ(encoder.position, -200);
+  CHECK_EQ(encoder.stats.valid_steps, 400);
+}
+
+
+static void test_16_bit_timer(void)
+{
+  check_wrap(0xFFFFU);
+
+  // Up to half the range between syncs is extended correctly.
+  sim_timer_t sim;
+  int32_t position = 0;
+  setup(&sim, 0xFFFFU, 0xFF00U, ROT_ENC_RESOLUTION_4X);
+  turn(&sim, &position, 30000, 30000);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 30000);
+  turn(&sim, &position, -30000, 30000);
+  turn(&sim, &position, -30000, 30000);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), -30000);
+}
+
+
+static void test_32_bit_timer(void)
+{
+  check_wrap(0xFFFFFFFFU);
+
+  // Steps of more than 16 bits between syncs.
+  sim_timer_t sim;
+  int32_t position = 0;
+  setup(&sim, 0xFFFFFFFFU, 0xFFFFFF00U, ROT_ENC_RESOLUTION_4X);
+  turn(&sim, &position, 100000, 100000);
+  CHECK_EQ(encoder.position, 100000);
+}
+
+
+static void test_resolution(void)
+{
+  sim_timer_t sim;
+  int32_t position = 0;
+
+  // 1x counts once per 4 transitions, from where the timer started.
+  setup(&sim, 0xFFFFU, 0xFFFEU, ROT_ENC_RESOLUTION_1X);
+  turn(&sim, &position, 40, 3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 10);
+  turn(&sim, &position, -6, 3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 8);
+  turn(&sim, &position, -36, 3);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), -1);
+
+  // 2x counts once per 2 transitions.
+  position = 0;
+  setup(&sim, 0xFFFFU, 1U, ROT_ENC_RESOLUTION_2X);
+  turn(&sim, &position, -9, 4);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), -5);
+}
+
+
+static void test_position_wrap(void)
+{
+  sim_timer_t sim;
+  int32_t position = 0;
+
+  // Counts carry on normally as the 32 bit position wraps, either way. A
+  // saturating counter shows any jump that a narrow counter would hide.
+  setup(&sim, 0xFFFFU, 0U, ROT_ENC_RESOLUTION_2X);
+  encoder.count_mode = ROT_ENC_SATURATE;
+  encoder.counter_max = 100;
+  encoder.counter_min = -100;
+  encoder.position = INT32_MAX - 3;
+  turn(&sim, &position, 10, 2);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 5);
+  CHECK_EQ(encoder.position, INT32_MIN + 6);
+  turn(&sim, &position, -13, 1);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), -2);
+  CHECK_EQ(encoder.position, INT32_MAX - 6);
+}
+
+
+int main(void)
+{
+  test_16_bit_timer();
+  test_32_bit_timer();
+  test_resolution();
+  test_position_wrap();
+  return test_report("test_timer_backend");
+}
+
+
+// End of file. //
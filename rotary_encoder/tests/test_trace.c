@@ -0,0 +1,241 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+
+/**
+ * @file test_trace.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks the trace recorder: a dump replayed with
+ * rot_enc_replay_trace() matches the driver's count with skipped-step
+ * recovery on, a dump pauses only its own encoder, and transitions polled
+ * during an interrupt storm are traced.
+ */
+
+#define MAX_NUM_OF_ENCODERS   2
+#define ROT_ENC_TRACE_DEPTH   4096
+
+#include <stdlib.h>
+#include "rot_enc_test.h"
+#include "sim_encoder.h"
+
+#define NUM_OF_EDGES          1000
+
+static GPIO_TypeDef port;
+static UART_HandleTypeDef uart;
+static double edge_time[NUM_OF_EDGES];
+static int8_t edge_step[NUM_OF_EDGES];
+
+
+/**
+ * Finds a "trace <key> =" message in the captured log and parses its value.
+ * @param takes the message key, e.g. "recovery".
+ * @param takes the position to search from, updated to after the value.
+ * @param takes a pointer to write the value to.
+ * @return true if the key was found, false if not.
+ */
+static bool find_field(const char *key, uint32_t *position_ptr,
+                       uint32_t *value_ptr)
+{
+  char message[32];
+  snprintf(message, sizeof(message), "trace %s = ", key);
+
+  sim_uart_buffer[sim_uart_length < SIM_UART_BUFFER_SIZE ?
+                  sim_uart_length : SIM_UART_BUFFER_SIZE - 1] = '\0';
+  const char *found = strstr((const char *)&sim_uart_buffer[*position_ptr],
+                             message);
+  if (found == NULL)
+  {
+    return false;
+  }
+
+  char *end = NULL;
+  *value_ptr = (uint32_t)strtoul(found + strlen(message), &end, 0);
+  *position_ptr = (uint32_t)(end - (const char *)sim_uart_buffer);
+  return true;
+}
+
+
+/**
+ * Spins an encoder with interrupt latency, so some ISRs see double
+ * transitions, then dumps its trace and replays the dump.
+ */
+static void test_replay_recovery(void)
+{
+  test_reset_driver();
+  init_log_system(&uart);
+  port.IDR = 0;
+
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED,
+    .recover_skipped_steps = true
+  };
+  CHECK(init_rotary_encoder(&encoder));
+
+  // 10 us between edges, with 1 in 20 ISRs delayed by 1.2 edge intervals.
+  sim_encoder_spin(edge_time, edge_step, NUM_OF_EDGES, 1, 10000.0, 1000.0);
+  sim_encoder_t sim =
+  {
+    .handle_ptr = &encoder,
+    .edge_time = edge_time,
+    .edge_step = edge_step,
+    .num_of_edges = NUM_OF_EDGES,
+    .read_ns = 20.0,
+    .latency_ns = 200.0,
+    .exit_ns = 100.0,
+    .stall_ns = 12000.0,
+    .stall_per_thousand = 50
+  };
+  sim_encoder_run(&sim);
+  CHECK_EQ(encoder.counter, NUM_OF_EDGES);
+
+  sim_uart_clear();
+  rot_enc_dump_trace(&encoder);
+
+  uint32_t position = 0;
+  uint32_t recovery = 0;
+  uint32_t num_of_entries = 0;
+  CHECK(find_field("recovery", &position, &recovery));
+  CHECK(find_field("entries", &position, &num_of_entries));
+  CHECK_EQ(recovery, 1);
+
+  static uint32_t entries[ROT_ENC_TRACE_DEPTH];
+  uint32_t parsed = 0;
+  while (parsed < ROT_ENC_TRACE_DEPTH &&
+         find_field("entry", &position, &entries[parsed]))
+  {
+    ++parsed;
+  }
+  CHECK_EQ(parsed, num_of_entries);
+
+  rot_enc_replay_state_t state = {0, 0};
+  rot_enc_trace_result_t recovered;
+  rot_enc_replay_trace(entries, parsed, encoder.resolution, true, &state,
+                       &recovered);
+
+  rot_enc_replay_state_t plain_state = {0, 0};
+  rot_enc_trace_result_t plain;
+  rot_enc_replay_trace(entries, parsed, encoder.resolution, false,
+                       &plain_state, &plain);
+
+  printf("replay: driver count %d, replayed with recovery %d, without %d, "
+         "%u double transitions\n",
+         (int)encoder.counter, (int)recovered.net_counts,
+         (int)plain.net_counts, (unsigned)recovered.invalid_transitions);
+
+  CHECK(recovered.invalid_transitions > 0);
+  CHECK_EQ(recovered.gaps, 0);
+  CHECK_EQ(recovered.net_counts, encoder.counter);
+  CHECK_EQ(plain.net_counts,
+           encoder.counter - 2 * (int32_t)plain.invalid_transitions);
+}
+
+
+/**
+ * While one encoder's trace is being dumped, the other keeps recording.
+ */
+static void test_pause_per_encoder(void)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  rot_enc_handle_t first =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port
+  };
+  rot_enc_handle_t second =
+  {
+    .pin_a = GPIO_PIN_2,
+    .pin_b = GPIO_PIN_3,
+    .port_a = &port,
+    .port_b = &port
+  };
+  CHECK(init_rotary_encoder(&first));
+  CHECK(init_rotary_encoder(&second));
+
+  // As rot_enc_dump_trace() does for the first encoder.
+  trace_paused[first.id] = true;
+
+  int32_t first_position = 0;
+  int32_t second_position = 0;
+  test_turn(&first, &first_position, 3, 1);
+  test_turn(&second, &second_position, 5, 1);
+
+  CHECK_EQ(trace_count[first.id], 0);
+  CHECK_EQ(trace_dropped[first.id], 3);
+  CHECK_EQ(trace_count[second.id], 5);
+  CHECK_EQ(trace_dropped[second.id], 0);
+  trace_paused[first.id] = false;
+}
+
+
+/**
+ * Transitions polled by rot_enc_tick() while the EXTI lines are masked are
+ * traced and counted.
+ */
+static void test_storm_traced(void)
+{
+  test_reset_driver();
+  port.IDR = 0;
+
+  rot_enc_handle_t encoder =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  CHECK(init_rotary_encoder(&encoder));
+  encoder.storm_active = true;
+
+  for (int32_t position = 1; position <= 8; ++position)
+  {
+    ++sim_tick;
+    test_set_pins(&encoder, test_quadrature_state(position));
+    rot_enc_tick();
+  }
+
+  CHECK_EQ(encoder.counter, 8);
+  CHECK_EQ(trace_count[encoder.id], 8);
+}
+
+
+int main(void)
+{
+  test_replay_recovery();
+  test_pause_per_encoder();
+  test_storm_traced();
+  return test_report("test_trace");
+}
+
+
+// End of file. //
@@ -0,0 +1,139 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+/**
+ * @file test_velocity.c
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Checks the velocity estimate as it switches between measuring the
+ * edge period at low speed and counting edges per window at high speed, its
+ * decay and timeout once the encoder stops, and the sign of acceleration.
+ */
+
+#include "rot_enc_test.h"
+
+static GPIO_TypeDef port;
+static rot_enc_handle_t encoder;
+static int32_t position;
+
+
+/**
+ * Registers a fresh encoder at tick 0.
+ */
+static void setup(void)
+{
+  test_reset_driver();
+  port.IDR = 0;
+  position = 0;
+
+  rot_enc_handle_t fresh =
+  {
+    .pin_a = GPIO_PIN_0,
+    .pin_b = GPIO_PIN_1,
+    .port_a = &port,
+    .port_b = &port,
+    .count_mode = ROT_ENC_UNBOUNDED
+  };
+  encoder = fresh;
+  CHECK(init_rotary_encoder(&encoder));
+}
+
+
+/**
+ * Fewer than ROT_ENC_VELOCITY_MIN_COUNTS edges per window are timed by the
+ * period between them, more are counted over the window.
+ */
+static void test_period_and_window(void)
+{
+  setup();
+  CHECK_EQ(rot_enc_get_velocity(&encoder), 0);
+
+  // One edge every 100 ms, measured by period.
+  for (int edge = 0; edge < 3; ++edge)
+  {
+    test_turn(&encoder, &position, 1, 100);
+    CHECK_EQ(rot_enc_get_velocity(&encoder), 10);
+  }
+
+  // 50 edges 1 ms apart, counted over the 50 ms since the last estimate.
+  test_turn(&encoder, &position, 50, 1);
+  CHECK_EQ(rot_enc_get_velocity(&encoder), 1000);
+
+  // Within the window the previous estimate is kept.
+  test_turn(&encoder, &position, -10, 1);
+  CHECK_EQ(rot_enc_get_velocity(&encoder), 1000);
+
+  // Turning back, counted again, then timed by period as it slows.
+  test_turn(&encoder, &position, -30, 3);
+  CHECK_EQ(rot_enc_get_velocity(&encoder), -400);
+  test_turn(&encoder, &position, -1, 40);
+  CHECK_EQ(rot_enc_get_velocity(&encoder), -25);
+}
+
+
+/**
+ * Speeding up from rest in either direction gives an acceleration of the
+ * same sign.
+ */
+static void test_acceleration(void)
+{
+  setup();
+  test_turn(&encoder, &position, 50, 1);
+  CHECK(rot_enc_get_acceleration(&encoder) > 0);
+
+  setup();
+  test_turn(&encoder, &position, -50, 1);
+  CHECK(rot_enc_get_acceleration(&encoder) < 0);
+  CHECK_EQ(rot_enc_get_velocity(&encoder), -1000);
+}
+
+
+/**
+ * Once edges stop, the time since the last edge stands in for the period,
+ * and past ROT_ENC_VELOCITY_TIMEOUT the encoder is stopped.
+ */
+static void test_timeout(void)
+{
+  setup();
+  test_turn(&encoder, &position, 2, 50);
+  CHECK_EQ(rot_enc_get_velocity(&encoder), 20);
+
+  // The next edge is overdue, so the estimate decays.
+  sim_tick += 200;
+  CHECK_EQ(rot_enc_get_velocity(&encoder), 5);
+
+  sim_tick += ROT_ENC_VELOCITY_TIMEOUT - 200;
+  CHECK_EQ(rot_enc_get_velocity(&encoder), 0);
+  CHECK_EQ(rot_enc_get_count_value(&encoder), 2);
+}
+
+
+int main(void)
+{
+  test_period_and_window();
+  test_acceleration();
+  test_timeout();
+  return test_report("test_velocity");
+}
+
+
+// End of file. //
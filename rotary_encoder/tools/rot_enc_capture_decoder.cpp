@@ -0,0 +1,756 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rot_enc_capture_decoder.cpp
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Host tool to decode logic analyser captures of encoder A/B lines
+ * offline, using the same decode table and block decoder as the driver.
+ * Reports counts, glitches and a velocity profile for each channel pair.
+ *
+ * Captures are memory mapped and decoded in chunks, so files larger than
+ * RAM are fine. Supported formats are raw binary with one byte (bin8) or two
+ * bytes (bin16, little endian) per sample with one bit per channel, as
+ * exported by sigrok and most logic analysers, or CSV with one sample per
+ * line and comma separated columns. Each CSV column holds one channel's
+ * level, 0 for low and any other integer for high. A first column of
+ * timestamps, as exported by Saleae and sigrok, is skipped; it is recognised
+ * by a header starting "Time" or by fractional values. Lines starting with
+ * ';' or '#', and non-numeric header lines, are skipped.
+ *
+ * Decoding at 4x uses only the vectorised block decoder, and runs at hundreds
+ * of MB/s. At 2x and 1x the detent state machine also has to run sample by
+ * sample over every chunk that has changes in it, which is several times
+ * slower, though idle stretches still go at block decoder speed. Decode at 4x
+ * and divide if throughput matters more than matching the driver's detent
+ * behaviour exactly.
+ *
+ * Build on a PC, with optimisation so the inner loop is vectorised:
+ * g++ -std=c++17 -O3 -march=native -I../driver rot_enc_capture_decoder.cpp
+ *     ../driver/rotary_encoder_decode.c -o rot_enc_capture_decoder
+ *
+ * Usage:
+ * rot_enc_capture_decoder [options] capture_file
+ * --format bin8|bin16|csv   Capture format, bin8 as default.
+ * --channel A,B             Bit numbers of an A/B pair, repeat for each
+ *                           encoder. 0,1 as default.
+ * --columns C,...           CSV columns to decode, counted from 0, which
+ *                           become bits 0, 1, ... of each sample. Every
+ *                           column except a timestamp column as default.
+ * --resolution 4|2|1        Counts per quadrature cycle, 4 as default. 2 and
+ *                           1 are slower, see above.
+ * --rate HZ                 Sample rate, 1000000 as default.
+ * --window SAMPLES          Samples per velocity profile point, rate / 100
+ *                           as default.
+ * --profile FILE            Write the velocity profile as CSV to FILE.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rotary_encoder_decode.h"
+
+// Samples decoded per chunk, sized so a chunk stays in cache while every
+// channel is decoded from it.
+static const size_t CHUNK_SAMPLES = 32768;
+
+
+/**
+ * Capture file formats.
+ */
+enum class capture_format_t
+{
+    BIN8,
+    BIN16,
+    CSV
+};
+
+
+/**
+ * Decode state and totals for one A/B channel pair.
+ */
+struct channel_t
+{
+    uint32_t bit_a;
+    uint32_t bit_b;
+
+    // State after the last sample decoded, in 0b000000AB format.
+    uint8_t state;
+
+    // Transitions since the last detent, for the 2x and 1x resolutions.
+    uint8_t detent_state;
+
+    int64_t net_steps;
+    int64_t counts;
+    uint64_t transitions;
+    uint64_t glitches;
+
+    // Net transitions in each velocity profile window.
+    std::vector<int32_t> profile;
+    int32_t window_steps;
+};
+
+
+/**
+ * Options from the command line.
+ */
+struct options_t
+{
+    capture_format_t format = capture_format_t::BIN8;
+    std::vector<channel_t> channels;
+
+    // CSV columns to decode, in sample bit order. Empty to choose them from
+    // the capture.
+    std::vector<uint32_t> columns;
+    uint32_t resolution_index = 0;
+    double rate = 1000000.0;
+    uint64_t window = 0;
+    const char *profile_path = nullptr;
+    const char *capture_path = nullptr;
+};
+
+
+/**
+ * Runs the detent state machine over the changes in a chunk. Only needed for
+ * 2x and 1x resolution, as 4x counts are the net transitions. This is a
+ * scalar loop, so it is several times slower than the block decoder.
+ * @param takes the channel to update.
+ * @param takes a pointer to the samples in the chunk.
+ * @param takes the number of samples.
+ * @param takes the resolution index into rot_enc_state_table.
+ */
+static void count_detents(channel_t &channel,
+                          const uint16_t *samples,
+                          size_t num_of_samples,
+                          uint32_t resolution_index)
+{
+    uint8_t state = channel.state;
+
+    for (size_t index = 0; index < num_of_samples; ++index)
+    {
+        uint8_t new_state = (uint8_t)((((samples[index] >> channel.bit_a) & 1U)
+                                       << 1) |
+                                      ((samples[index] >> channel.bit_b) & 1U));
+        if (new_state != state)
+        {
+            uint8_t entry = rot_enc_state_table[resolution_index]
+                                               [channel.detent_state]
+                                               [(state << 2) | new_state];
+            channel.detent_state = ROT_ENC_STATE_NEXT(entry);
+            channel.counts += ROT_ENC_STATE_COUNT(entry);
+            state = new_state;
+        }
+    }
+}
+
+
+/**
+ * Decodes a chunk of samples for every channel, and fills in the velocity
+ * profile. The chunk must not cross a profile window boundary.
+ * @param takes the options, holding the channels.
+ * @param takes a pointer to the samples in the chunk.
+ * @param takes the number of samples.
+ * @param takes true if the chunk completes a profile window.
+ */
+static void decode_chunk(options_t &options,
+                         const uint16_t *samples,
+                         size_t num_of_samples,
+                         bool window_complete)
+{
+    for (channel_t &channel : options.channels)
+    {
+        rot_enc_block_result_t result;
+        uint8_t state = rot_enc_decode_block(samples,
+                                             (uint32_t)num_of_samples,
+                                             channel.bit_a,
+                                             channel.bit_b,
+                                             channel.state,
+                                             &result);
+
+        // The detent state machine depends on the path taken, so it cannot be
+        // derived from the block totals, but a chunk with no changes leaves it
+        // where it was.
+        if (options.resolution_index != 0 &&
+            (result.transitions != 0 || result.invalid_transitions != 0))
+        {
+            count_detents(channel, samples, num_of_samples,
+                          options.resolution_index);
+        }
+        channel.state = state;
+        channel.net_steps += result.net_steps;
+        channel.transitions += result.transitions;
+        channel.glitches += result.invalid_transitions;
+        channel.window_steps += result.net_steps;
+
+        if (window_complete)
+        {
+            channel.profile.push_back(channel.window_steps);
+            channel.window_steps = 0;
+        }
+    }
+}
+
+
+/**
+ * Splits a run of samples into chunks that respect profile window
+ * boundaries, and decodes them.
+ * @param takes the options, holding the channels.
+ * @param takes a pointer to the samples.
+ * @param takes the number of samples.
+ * @param takes the number of samples already decoded, updated on return.
+ */
+static void decode_samples(options_t &options,
+                           const uint16_t *samples,
+                           size_t num_of_samples,
+                           uint64_t &samples_decoded)
+{
+    // Start each channel from the first sample, so it is not seen as an edge.
+    if (samples_decoded == 0 && num_of_samples > 0)
+    {
+        for (channel_t &channel : options.channels)
+        {
+            channel.state = (uint8_t)((((samples[0] >> channel.bit_a) & 1U)
+                                       << 1) |
+                                      ((samples[0] >> channel.bit_b) & 1U));
+        }
+    }
+
+    while (num_of_samples > 0)
+    {
+        size_t length = num_of_samples;
+        bool window_complete = false;
+
+        if (options.window != 0)
+        {
+            uint64_t to_boundary = options.window -
+                                   (samples_decoded % options.window);
+            if (to_boundary <= length)
+            {
+                length = (size_t)to_boundary;
+                window_complete = true;
+            }
+        }
+
+        decode_chunk(options, samples, length, window_complete);
+
+        samples += length;
+        num_of_samples -= length;
+        samples_decoded += length;
+    }
+}
+
+
+/**
+ * Decodes a mapped binary capture, widening bin8 samples to 16 bits one chunk
+ * at a time.
+ * @param takes the options, holding the channels.
+ * @param takes a pointer to the mapped capture.
+ * @param takes the size of the capture in bytes.
+ * @return the number of samples decoded.
+ */
+static uint64_t decode_binary(options_t &options,
+                              const uint8_t *data,
+                              size_t size)
+{
+    std::vector<uint16_t> chunk(CHUNK_SAMPLES);
+    uint64_t samples_decoded = 0;
+
+    if (options.format == capture_format_t::BIN16)
+    {
+        size_t num_of_samples = size / 2;
+        for (size_t offset = 0; offset < num_of_samples;
+             offset += CHUNK_SAMPLES)
+        {
+            size_t length = std::min(CHUNK_SAMPLES, num_of_samples - offset);
+            std::memcpy(chunk.data(), data + (offset * 2), length * 2);
+            decode_samples(options, chunk.data(), length, samples_decoded);
+        }
+    }
+    else
+    {
+        for (size_t offset = 0; offset < size; offset += CHUNK_SAMPLES)
+        {
+            size_t length = std::min(CHUNK_SAMPLES, size - offset);
+            for (size_t index = 0; index < length; ++index)
+            {
+                chunk[index] = data[offset + index];
+            }
+            decode_samples(options, chunk.data(), length, samples_decoded);
+        }
+    }
+    return samples_decoded;
+}
+
+
+/**
+ * Finds the next comma separated field in a CSV line.
+ * @param takes a pointer to the start of the field.
+ * @param takes a pointer to the end of the line.
+ * @return a pointer to the end of the field, the comma or the line end.
+ */
+static const uint8_t *field_end(const uint8_t *field, const uint8_t *line_end)
+{
+    const uint8_t *comma = static_cast<const uint8_t *>(
+        std::memchr(field, ',', (size_t)(line_end - field)));
+    return comma ? comma : line_end;
+}
+
+
+/**
+ * @param takes a pointer to the start of a field.
+ * @param takes a pointer to the end of the field.
+ * @return true if the field is a number, e.g. a level or a timestamp.
+ */
+static bool field_is_number(const uint8_t *field, const uint8_t *end)
+{
+    while (field < end && (*field == ' ' || *field == '"'))
+    {
+        ++field;
+    }
+    return field < end && ((*field >= '0' && *field <= '9') ||
+                           *field == '-' || *field == '.');
+}
+
+
+/**
+ * Reads a channel level, treating any non-zero integer as high.
+ * @param takes a pointer to the start of a field.
+ * @param takes a pointer to the end of the field.
+ * @return 1 if the level is high, 0 if low.
+ */
+static uint16_t field_level(const uint8_t *field, const uint8_t *end)
+{
+    while (field < end && (*field == ' ' || *field == '"'))
+    {
+        ++field;
+    }
+    uint16_t level = 0;
+    while (field < end && *field >= '0' && *field <= '9')
+    {
+        level |= (*field != '0');
+        ++field;
+    }
+    return level;
+}
+
+
+/**
+ * Picks the CSV columns to decode, when --columns was not given. Every
+ * column is a channel, except a first column of timestamps, recognised by a
+ * header starting "Time" or by a fractional value.
+ * @param takes the options, to write the columns to.
+ * @param takes the header line, or nullptr if there was none.
+ * @param takes the first data line, and its end.
+ */
+static void choose_columns(options_t &options,
+                           const std::string *header,
+                           const uint8_t *line,
+                           const uint8_t *line_end)
+{
+    const uint8_t *first_end = field_end(line, line_end);
+    bool has_time = std::memchr(line, '.', (size_t)(first_end - line)) !=
+                    nullptr;
+
+    if (header != nullptr)
+    {
+        std::string first = header->substr(0, header->find(','));
+        first.erase(0, first.find_first_not_of(" \""));
+        has_time |= (first.size() >= 4 &&
+                     (first.compare(0, 4, "Time") == 0 ||
+                      first.compare(0, 4, "time") == 0));
+    }
+
+    uint32_t num_of_columns = 1;
+    for (const uint8_t *field = line; field < line_end; ++field)
+    {
+        num_of_columns += (*field == ',');
+    }
+    for (uint32_t column = has_time ? 1 : 0;
+         column < num_of_columns && options.columns.size() < 16; ++column)
+    {
+        options.columns.push_back(column);
+    }
+}
+
+
+/**
+ * Decodes a mapped CSV capture. Each line is split on commas, and the level
+ * in each selected column becomes one bit of the sample, the first selected
+ * column in bit 0.
+ * @param takes the options, holding the channels and columns.
+ * @param takes a pointer to the mapped capture.
+ * @param takes the size of the capture in bytes.
+ * @return the number of samples decoded.
+ */
+static uint64_t decode_csv(options_t &options,
+                           const uint8_t *data,
+                           size_t size)
+{
+    std::vector<uint16_t> chunk(CHUNK_SAMPLES);
+    std::vector<int32_t> bit_of_column;
+    std::string header;
+    bool have_header = false;
+    size_t length = 0;
+    uint64_t samples_decoded = 0;
+    size_t position = 0;
+
+    while (position < size)
+    {
+        const uint8_t *line = data + position;
+        const uint8_t *end = static_cast<const uint8_t *>(
+            std::memchr(line, '\n', size - position));
+        size_t line_length = end ? (size_t)(end - line) : (size - position);
+        const uint8_t *line_end = line + line_length;
+        position += line_length + 1;
+
+        if (line_length != 0 && line_end[-1] == '\r')
+        {
+            --line_end;
+        }
+        if (line_end == line || line[0] == ';' || line[0] == '#')
+        {
+            continue;
+        }
+
+        // A line that does not start with a number is a header.
+        if (!field_is_number(line, field_end(line, line_end)))
+        {
+            header.assign(reinterpret_cast<const char *>(line),
+                          (size_t)(line_end - line));
+            have_header = true;
+            continue;
+        }
+
+        if (bit_of_column.empty())
+        {
+            if (options.columns.empty())
+            {
+                choose_columns(options, have_header ? &header : nullptr,
+                               line, line_end);
+            }
+            for (size_t bit = 0; bit < options.columns.size(); ++bit)
+            {
+                uint32_t column = options.columns[bit];
+                if (column >= bit_of_column.size())
+                {
+                    bit_of_column.resize(column + 1, -1);
+                }
+                bit_of_column[column] = (int32_t)bit;
+            }
+        }
+
+        uint16_t sample = 0;
+        uint32_t column = 0;
+        for (const uint8_t *field = line;
+             field <= line_end && column < bit_of_column.size();
+             ++column)
+        {
+            const uint8_t *next = field_end(field, line_end);
+            if (bit_of_column[column] >= 0)
+            {
+                sample |= (uint16_t)(field_level(field, next) <<
+                                     bit_of_column[column]);
+            }
+            field = next + 1;
+        }
+
+        chunk[length++] = sample;
+        if (length == CHUNK_SAMPLES)
+        {
+            decode_samples(options, chunk.data(), length, samples_decoded);
+            length = 0;
+        }
+    }
+
+    decode_samples(options, chunk.data(), length, samples_decoded);
+    return samples_decoded;
+}
+
+
+/**
+ * Parses the command line.
+ * @return true if the options are valid, false if not.
+ */
+static bool parse_options(int argc, char **argv, options_t &options)
+{
+    for (int index = 1; index < argc; ++index)
+    {
+        std::string arg = argv[index];
+        const char *value = (index + 1 < argc) ? argv[index + 1] : nullptr;
+
+        if (arg.rfind("--", 0) != 0)
+        {
+            options.capture_path = argv[index];
+            continue;
+        }
+        if (value == nullptr)
+        {
+            return false;
+        }
+        ++index;
+
+        if (arg == "--format")
+        {
+            std::string format = value;
+            if (format == "bin8")
+            {
+                options.format = capture_format_t::BIN8;
+            }
+            else if (format == "bin16")
+            {
+                options.format = capture_format_t::BIN16;
+            }
+            else if (format == "csv")
+            {
+                options.format = capture_format_t::CSV;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--channel")
+        {
+            unsigned bit_a = 0;
+            unsigned bit_b = 0;
+            if (std::sscanf(value, "%u,%u", &bit_a, &bit_b) != 2 ||
+                bit_a > 15 || bit_b > 15)
+            {
+                return false;
+            }
+            channel_t channel = {};
+            channel.bit_a = bit_a;
+            channel.bit_b = bit_b;
+            options.channels.push_back(channel);
+        }
+        else if (arg == "--columns")
+        {
+            options.columns.clear();
+            for (const char *field = value; *field != '\0';)
+            {
+                char *end = nullptr;
+                unsigned long column = std::strtoul(field, &end, 10);
+                if (end == field || options.columns.size() == 16)
+                {
+                    return false;
+                }
+                options.columns.push_back((uint32_t)column);
+                field = (*end == ',') ? end + 1 : end;
+                if (*end != ',' && *end != '\0')
+                {
+                    return false;
+                }
+            }
+        }
+        else if (arg == "--resolution")
+        {
+            int resolution = std::atoi(value);
+            if (resolution == 4)
+            {
+                options.resolution_index = 0;
+            }
+            else if (resolution == 2)
+            {
+                options.resolution_index = 1;
+            }
+            else if (resolution == 1)
+            {
+                options.resolution_index = 2;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (arg == "--rate")
+        {
+            options.rate = std::atof(value);
+        }
+        else if (arg == "--window")
+        {
+            options.window = std::strtoull(value, nullptr, 10);
+        }
+        else if (arg == "--profile")
+        {
+            options.profile_path = value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (options.channels.empty())
+    {
+        channel_t channel = {};
+        channel.bit_a = 0;
+        channel.bit_b = 1;
+        options.channels.push_back(channel);
+    }
+    if (options.window == 0)
+    {
+        options.window = (uint64_t)(options.rate / 100.0);
+    }
+    return options.capture_path != nullptr && options.rate > 0.0;
+}
+
+
+/**
+ * Writes the velocity profile as CSV, one row per window with the time in
+ * seconds and each channel's velocity in transitions per second.
+ * @return true if the file was written, false if not.
+ */
+static bool write_profile(const options_t &options)
+{
+    FILE *file = std::fopen(options.profile_path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::fprintf(file, "time_s");
+    for (size_t index = 0; index < options.channels.size(); ++index)
+    {
+        std::fprintf(file, ",ch%zu_steps_per_s", index);
+    }
+    std::fprintf(file, "\n");
+
+    double window_s = (double)options.window / options.rate;
+    size_t rows = options.channels[0].profile.size();
+    for (size_t row = 0; row < rows; ++row)
+    {
+        std::fprintf(file, "%.6f", (double)(row + 1) * window_s);
+        for (const channel_t &channel : options.channels)
+        {
+            std::fprintf(file, ",%.1f", channel.profile[row] / window_s);
+        }
+        std::fprintf(file, "\n");
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    options_t options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--format bin8|bin16|csv] [--channel A,B]... "
+                     "[--columns C,...] [--resolution 4|2|1] [--rate HZ] "
+                     "[--window SAMPLES] "
+                     "[--profile FILE] capture_file\n", argv[0]);
+        return 2;
+    }
+
+    int fd = open(options.capture_path, O_RDONLY);
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0)
+    {
+        std::fprintf(stderr, "%s: %s\n", options.capture_path,
+                     std::strerror(errno));
+        return 1;
+    }
+
+    size_t size = (size_t)file_stat.st_size;
+    const uint8_t *data = nullptr;
+    if (size > 0)
+    {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            std::fprintf(stderr, "%s: %s\n", options.capture_path,
+                         std::strerror(errno));
+            close(fd);
+            return 1;
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t *>(mapping);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t num_of_samples = (options.format == capture_format_t::CSV) ?
+                              decode_csv(options, data, size) :
+                              decode_binary(options, data, size);
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+
+    if (data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+    close(fd);
+
+    std::printf("%llu samples, %.3f s of capture, decoded in %.3f s "
+                "(%.1f MB/s)\n",
+                (unsigned long long)num_of_samples,
+                (double)num_of_samples / options.rate, seconds,
+                (seconds > 0.0) ? ((double)size / seconds / 1e6) : 0.0);
+
+    for (size_t index = 0; index < options.channels.size(); ++index)
+    {
+        const channel_t &channel = options.channels[index];
+        int64_t counts = (options.resolution_index == 0) ?
+                         channel.net_steps : channel.counts;
+        int32_t peak = 0;
+        for (int32_t steps : channel.profile)
+        {
+            peak = (std::abs(steps) > std::abs(peak)) ? steps : peak;
+        }
+
+        std::printf("ch%zu (A=%u B=%u): count %lld, net transitions %lld, "
+                    "valid transitions %llu, glitches %llu, "
+                    "peak %.1f transitions/s\n",
+                    index, channel.bit_a, channel.bit_b,
+                    (long long)counts, (long long)channel.net_steps,
+                    (unsigned long long)channel.transitions,
+                    (unsigned long long)channel.glitches,
+                    peak * options.rate / (double)options.window);
+    }
+
+    if (options.profile_path != nullptr && !write_profile(options))
+    {
+        std::fprintf(stderr, "%s: %s\n", options.profile_path,
+                     std::strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
+
+// End of file. //
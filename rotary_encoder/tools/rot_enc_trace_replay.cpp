@@ -0,0 +1,249 @@
+/******************************************************************************
+ @copyright Copyright © 2022 by Jason Duffy.
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+******************************************************************************/
+
+
+/**
+ * @file rot_enc_trace_replay.cpp
+ * @ingroup rotary_encoder
+ * @date 16th October 2026
+ * @brief Host tool to replay trace recorder dumps from rot_enc_dump_trace()
+ * through the driver's decode state machine. Lists every missed step,
+ * bounce and gap in the trace with its time, and totals for each encoder.
+ *
+ * Save the UART log to a file, the trace lines can be mixed in with any
+ * other log output. Build on a PC:
+ * g++ -std=c++17 -O2 -I../driver rot_enc_trace_replay.cpp
+ *     ../driver/rotary_encoder_decode.c -o rot_enc_trace_replay
+ *
+ * Usage:
+ * rot_enc_trace_replay [--rate HZ] log_file
+ * --rate HZ    Timestamp rate, ROT_ENC_TIMESTAMP_HZ, 1000 as default.
+ */
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rotary_encoder_decode.h"
+
+
+/**
+ * One encoder's dump, as parsed from the log.
+ */
+struct trace_t
+{
+    unsigned long id = 0;
+    unsigned long resolution = 0;
+    bool recovery = false;
+    unsigned long dropped = 0;
+    std::vector<uint32_t> entries;
+};
+
+
+/**
+ * Finds a "trace <key> =" message in a log line and parses its value, in
+ * decimal or 0x prefixed hex.
+ * @param takes the log line.
+ * @param takes the message key, e.g. "entry".
+ * @param takes a reference to write the value to.
+ * @return true if the line holds the key, false if not.
+ */
+static bool parse_field(const std::string &line,
+                        const char *key,
+                        unsigned long &value)
+{
+    std::string message = std::string("trace ") + key + " = ";
+    size_t position = line.find(message);
+    if (position == std::string::npos)
+    {
+        return false;
+    }
+    value = std::strtoul(line.c_str() + position + message.size(), nullptr, 0);
+    return true;
+}
+
+
+/**
+ * Reads every trace dump from a log file.
+ * @param takes the open log file.
+ * @return the dumps, in the order they were logged.
+ */
+static std::vector<trace_t> read_traces(FILE *file)
+{
+    std::vector<trace_t> traces;
+    char buffer[256];
+
+    while (std::fgets(buffer, sizeof(buffer), file) != nullptr)
+    {
+        std::string line = buffer;
+        unsigned long value = 0;
+
+        if (parse_field(line, "encoder id", value))
+        {
+            traces.emplace_back();
+            traces.back().id = value;
+        }
+        else if (traces.empty())
+        {
+            continue;
+        }
+        else if (parse_field(line, "resolution", value))
+        {
+            traces.back().resolution = (value <= 2) ? value : 0;
+        }
+        else if (parse_field(line, "recovery", value))
+        {
+            traces.back().recovery = (value != 0);
+        }
+        else if (parse_field(line, "dropped", value))
+        {
+            traces.back().dropped = value;
+        }
+        else if (parse_field(line, "entry", value))
+        {
+            traces.back().entries.push_back((uint32_t)value);
+        }
+    }
+    return traces;
+}
+
+
+/**
+ * Replays one dump entry by entry, printing each anomaly, then the totals.
+ * @param takes the dump.
+ * @param takes the timestamp rate in Hz.
+ */
+static void replay(const trace_t &trace, double rate)
+{
+    static const char *const resolutions[] = {"4x", "2x", "1x"};
+
+    std::printf("encoder %lu, %s%s, %zu entries, %lu dropped before the "
+                "dump\n",
+                trace.id, resolutions[trace.resolution],
+                trace.recovery ? " with skipped-step recovery" : "",
+                trace.entries.size(), trace.dropped);
+
+    rot_enc_replay_state_t state = {0, 0};
+    uint64_t time = 0;
+    for (size_t index = 0; index < trace.entries.size(); ++index)
+    {
+        uint32_t entry = trace.entries[index];
+        uint8_t transition = ROT_ENC_TRACE_TRANSITION(entry);
+        time += ROT_ENC_TRACE_DELTA(entry);
+
+        rot_enc_trace_result_t result;
+        rot_enc_replay_trace(&entry, 1, trace.resolution, trace.recovery,
+                             &state, &result);
+
+        const char *problem = nullptr;
+        if (index > 0 &&
+            (transition >> 2) !=
+            (ROT_ENC_TRACE_TRANSITION(trace.entries[index - 1]) & 0x03U))
+        {
+            problem = "entries missing from trace";
+        }
+        else if (result.invalid_transitions != 0)
+        {
+            problem = (result.transitions != 0) ?
+                      "both phases changed, step recovered" :
+                      "both phases changed, step missed";
+        }
+        else if (result.bounces != 0)
+        {
+            problem = "bounce";
+        }
+
+        if (problem != nullptr)
+        {
+            std::printf("  %10.4f s  entry %zu  %u%u -> %u%u  %s\n",
+                        (double)time / rate, index,
+                        (transition >> 3) & 1U, (transition >> 2) & 1U,
+                        (transition >> 1) & 1U, transition & 1U, problem);
+        }
+    }
+
+    rot_enc_trace_result_t totals;
+    rot_enc_replay_state_t totals_state = {0, 0};
+    rot_enc_replay_trace(trace.entries.data(),
+                         (uint32_t)trace.entries.size(),
+                         trace.resolution, trace.recovery, &totals_state,
+                         &totals);
+
+    std::printf("  %.4f s traced: count %" PRId32 ", net transitions %" PRId32
+                ", valid %" PRIu32 ", double transitions %" PRIu32
+                ", bounces %" PRIu32 ", trace gaps %" PRIu32 "\n",
+                (double)totals.duration / rate, totals.net_counts,
+                totals.net_steps, totals.transitions,
+                totals.invalid_transitions, totals.bounces, totals.gaps);
+}
+
+
+int main(int argc, char **argv)
+{
+    double rate = 1000.0;
+    const char *path = nullptr;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--rate") == 0 && index + 1 < argc)
+        {
+            rate = std::atof(argv[++index]);
+        }
+        else
+        {
+            path = argv[index];
+        }
+    }
+
+    if (path == nullptr || rate <= 0.0)
+    {
+        std::fprintf(stderr, "usage: %s [--rate HZ] log_file\n", argv[0]);
+        return 2;
+    }
+
+    FILE *file = std::fopen(path, "r");
+    if (file == nullptr)
+    {
+        std::perror(path);
+        return 1;
+    }
+    std::vector<trace_t> traces = read_traces(file);
+    std::fclose(file);
+
+    if (traces.empty())
+    {
+        std::fprintf(stderr, "%s: no trace dumps found\n", path);
+        return 1;
+    }
+    for (const trace_t &trace : traces)
+    {
+        replay(trace, rate);
+    }
+    return 0;
+}
+
+
+// End of file. //